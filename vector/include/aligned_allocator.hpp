@@ -0,0 +1,115 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "allocator_extensions.hpp"
+
+// aligned_allocator_t ---------------------------------------------------------
+
+// Allocator adaptor handing out buffers aligned on Alignment bytes, eg. 64 so
+// that AVX-512 loops start on a cache line and never split their loads
+// across two lines. It draws blocks of Alignment bytes, declared with that
+// alignment, from the Base allocator rebound to them: std::allocator then
+// uses the aligned operator new, and std::pmr::polymorphic_allocator passes
+// the alignment on to its memory resource. Base allocators that ignore
+// alignment, like malloc_allocator_t, fail to compile.
+
+// Buffers are rounded up to whole blocks. The slack is reported through the
+// allocate_at_least() extension documented in allocator_extensions.hpp, so
+// that vector_t uses it as capacity.
+
+// The allocator declares its alignment, which vector_t passes on to the
+// compiler (see "Buffer alignment" in allocator_extensions.hpp).
+// aligned_vector_t<T> in vector.hpp is the shorthand for a vector_t on
+// cache-line-aligned buffers.
+
+template<typename T, std::size_t Alignment = 64, typename Base = std::allocator<T>>
+struct aligned_allocator_t {
+public:
+    using value_type = T;
+
+    /// Alignment of the buffers.
+    static constexpr std::size_t alignment = Alignment;
+
+    static_assert(std::has_single_bit(Alignment),
+                  "aligned_allocator_t: the alignment must be a power of two");
+    static_assert(Alignment >= alignof(T),
+                  "aligned_allocator_t: the alignment must be at least alignof(T)");
+
+private:
+    /// Unit of allocation.
+    struct alignas(Alignment) block_t {
+        std::byte bytes[Alignment];
+    };
+
+    using block_allocator = typename std::allocator_traits<Base>::template rebind_alloc<block_t>;
+    using block_traits = std::allocator_traits<block_allocator>;
+
+    template<typename, std::size_t, typename>
+    friend struct aligned_allocator_t;
+
+    /// Allocator of the blocks.
+    [[no_unique_address]] block_allocator _base;
+
+    /// Returns the number of blocks holding n values.
+    static constexpr std::size_t blocks_for(std::size_t n) noexcept {
+        return (n * sizeof(T) + Alignment - 1) / Alignment;
+    }
+
+public:
+    using propagate_on_container_copy_assignment =
+        typename block_traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename block_traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename block_traits::propagate_on_container_swap;
+    using is_always_equal = typename block_traits::is_always_equal;
+
+    template<typename U>
+    struct rebind {
+        using other = aligned_allocator_t<
+            U, Alignment, typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    aligned_allocator_t() = default;
+
+    /// Draws the blocks from base.
+    explicit aligned_allocator_t(Base const &base) noexcept : _base(base) {}
+
+    template<typename U, typename OtherBase>
+    aligned_allocator_t(aligned_allocator_t<U, Alignment, OtherBase> const &other) noexcept
+        : _base(other._base) {}
+
+    T *allocate(std::size_t n) {
+        if (n > (std::size_t(-1) - Alignment) / sizeof(T))
+            throw std::bad_array_new_length();
+        return reinterpret_cast<T *>(block_traits::allocate(_base, blocks_for(n)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        block_traits::deallocate(_base, reinterpret_cast<block_t *>(p), blocks_for(n));
+    }
+
+    /// Allocates a buffer for at least n values, and reports how many values
+    /// fit in its whole blocks.
+    allocation_result_t<T> allocate_at_least(std::size_t n) {
+        T *p = allocate(n);
+        return {p, blocks_for(n) * Alignment / sizeof(T)};
+    }
+
+    /// Allocators are equal if they draw from equal base allocators.
+    template<typename U, typename OtherBase>
+    bool operator==(aligned_allocator_t<U, Alignment, OtherBase> const &other) const noexcept {
+        return _base == other._base;
+    }
+
+    /// Copying a container copies the allocator the way the base allocator
+    /// would be copied.
+    aligned_allocator_t select_on_container_copy_construction() const {
+        return aligned_allocator_t(
+            Base(block_traits::select_on_container_copy_construction(_base)));
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+
+// Allocator extensions --------------------------------------------------------
+
+// Besides the standard allocator requirements, vector_t detects a few
+// optional members on its allocator. They are declared here rather than in
+// vector.hpp, so that allocators providing them (malloc_allocator_t,
+// mmap_allocator_t, aligned_allocator_t) do not depend on vector_t.
+
+// Allocators may provide a member function
+// T *reallocate(T *p, std::size_t old_n, std::size_t new_n), with the semantics
+// of std::realloc, to resize buffers holding trivially relocatable values in
+// place when possible (see "Relocation" in vector.hpp).
+
+// Allocators may also report how much room they actually handed out: malloc
+// implementations round requests up to their size classes, and the slack
+// would otherwise be wasted. Following C++23 std::allocator::allocate_at_least,
+// such allocators provide allocate_at_least(n), and reallocate_at_least(p,
+// old_n, new_n) if they support reallocation, both returning a pointer and a
+// count of at least n values as members ptr and count. The count is used as
+// capacity, and is given back to deallocate().
+
+/// Buffer returned by allocate_at_least.
+template<typename T>
+struct allocation_result_t {
+    T *ptr;
+    std::size_t count;
+};
+
+/// Tells whether an allocator reports the actual size of its buffers.
+template<typename Allocator, typename T>
+inline constexpr bool has_allocate_at_least_v =
+    requires(Allocator &a, std::size_t n) {
+        { a.allocate_at_least(n).ptr } -> std::convertible_to<T *>;
+        { a.allocate_at_least(n).count } -> std::convertible_to<std::size_t>;
+    };
+
+/// Tells whether an allocator can resize buffers of T in place, and report
+/// their actual size.
+template<typename Allocator, typename T>
+inline constexpr bool has_reallocate_at_least_v =
+    requires(Allocator &a, T *p, std::size_t n) {
+        { a.reallocate_at_least(p, n, n).ptr } -> std::convertible_to<T *>;
+        { a.reallocate_at_least(p, n, n).count } -> std::convertible_to<std::size_t>;
+    };
+
+/// Tells whether an allocator can resize buffers of T in place.
+template<typename Allocator, typename T>
+inline constexpr bool has_reallocate_v =
+    requires(Allocator &a, T *p, std::size_t n) {
+        { a.reallocate(p, n, n) } -> std::same_as<T *>;
+    };
+
+// Buffer alignment ------------------------------------------------------------
+
+// Buffers are only guaranteed to be aligned on alignof(T). Allocators handing
+// out more strongly aligned buffers, like aligned_allocator_t in
+// aligned_allocator.hpp, declare it with a static constexpr std::size_t
+// member named alignment. vector_t then passes it on to the compiler through
+// std::assume_aligned on data() and begin(), so that loops over the values
+// can use aligned vector loads without checking the address first.
+
+/// Returns the alignment guaranteed for the buffers of T drawn from Allocator.
+template<typename Allocator, typename T>
+consteval std::size_t allocator_alignment() noexcept {
+    if constexpr (requires { std::size_t(Allocator::alignment); }) {
+        return Allocator::alignment > alignof(T) ? Allocator::alignment : alignof(T);
+    } else {
+        return alignof(T);
+    }
+}
+
+template<typename Allocator, typename T>
+inline constexpr std::size_t allocator_alignment_v = allocator_alignment<Allocator, T>();
@@ -0,0 +1,599 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "soa_vector.hpp"
+#include "vector.hpp"
+
+// aosoa_vector_t --------------------------------------------------------------
+
+// aosoa_vector_t<T, Lanes> stores the values of the aggregate struct T as an
+// array of structures of arrays: values are grouped in tiles of Lanes values,
+// and each tile holds an array of Lanes values per field, in declaration
+// order. A kernel touching every field of a value reads a few neighbouring
+// cache lines, like with vector_t<T>, while a field of a tile is a contiguous
+// array that fits a SIMD register or a few, like with soa_vector_t.
+
+// The fields of T are found like for soa_struct_vector_t (see
+// soa_vector.hpp), with the same restrictions on T.
+
+// Layout:
+// - the array of each field is aligned on the largest power of two no greater
+// than its size, Lanes * sizeof(field), capped at a cache line: the size of
+// the widest vector that loads it,
+// - tiles are padded to a whole number of cache lines, and the buffer is
+// allocated as an array of cache lines, so that every tile starts on a cache
+// line,
+// - the buffer is allocated with Allocator rebound to cache lines.
+
+// Tiles are the unit of storage: the capacity is always a whole number of
+// tiles. When emplace_back() runs out of capacity, the growth policy picks
+// the new capacity in values, like for vector_t, which is then rounded up to
+// whole tiles. reserve(n) also rounds n up to whole tiles.
+
+// Lifetime rules are the ones of soa_vector_t: _size is the number of values
+// whose fields are all alive, the unused lanes of the last tile hold no
+// objects, and relocating the buffer copies the used tiles with a single
+// memcpy when every field is trivially relocatable.
+
+// tiles() returns a random access range of tile_t views, for SIMD kernels:
+//
+//     for (auto tile : particles.tiles()) {
+//         std::span<float> x = tile.col<&particle_t::x>();
+//         std::span<float const> vx = tile.col<&particle_t::vx>();
+//         for (std::size_t l = 0; l < x.size(); l++)
+//             x[l] += vx[l] * dt;
+//     }
+//
+// The spans of a tile have size() values, which is Lanes except in the last
+// tile, and their data() is aligned for the compiler (std::assume_aligned), so
+// that such loops compile to aligned vector loads and stores. Fields may
+// not be aligned on more than a cache line, which is the alignment of tiles.
+
+template<typename T, std::size_t Lanes, typename Allocator = std::allocator<std::byte>,
+         typename GrowthPolicy = doubling_growth_t<>>
+struct aosoa_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+
+    /// Types of the fields of T.
+    using field_types = soa_detail::fields_t<T>;
+
+    /// Type of field K.
+    template<std::size_t K>
+    using field_type = std::tuple_element_t<K, field_types>;
+
+    /// Number of fields of T.
+    static constexpr std::size_t field_count = std::tuple_size_v<field_types>;
+
+    /// Number of values per tile.
+    static constexpr std::size_t lanes = Lanes;
+
+    /// Alignment of the tiles.
+    static constexpr std::size_t cache_line = 64;
+
+    /// Alignment of the array of field K in a tile.
+    template<std::size_t K>
+    static constexpr std::size_t field_alignment =
+        std::max(alignof(field_type<K>),
+                 std::min(cache_line, std::bit_floor(Lanes * sizeof(field_type<K>))));
+
+private:
+    static_assert(Lanes > 0, "aosoa_vector_t: tiles must have at least one lane");
+    static_assert(std::is_aggregate_v<T> && !std::is_union_v<T> && !std::is_const_v<T>,
+                  "aosoa_vector_t: T must be an aggregate struct");
+    static_assert([]<typename... Fs>(std::tuple<Fs...> *) {
+                      return ((alignof(Fs) <= cache_line) && ...);
+                  }(static_cast<field_types *>(nullptr)),
+                  "aosoa_vector_t: fields aligned on more than a cache line are not supported");
+
+    /// Unit of allocation.
+    struct alignas(cache_line) line_t {
+        std::byte bytes[cache_line];
+    };
+
+    using line_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<line_t>;
+    using alloc_traits = std::allocator_traits<line_allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::pointer, line_t *>,
+                  "aosoa_vector_t: fancy pointers are not supported");
+
+    /// Calls fn(std::integral_constant<std::size_t, K>()) for each field K.
+    template<typename Fn>
+    static void for_each_field(Fn &&fn) {
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            (fn(std::integral_constant<std::size_t, K>()), ...);
+        }(std::make_index_sequence<field_count>());
+    }
+
+    /// Offset of the array of each field in a tile, followed by the size of
+    /// a tile, in bytes.
+    static constexpr std::array<std::size_t, field_count + 1> offsets = [] {
+        std::array<std::size_t, field_count + 1> result{};
+        std::size_t offset = 0;
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            ((offset = (offset + field_alignment<K> - 1) / field_alignment<K> * field_alignment<K>,
+              result[K] = offset, offset += Lanes * sizeof(field_type<K>)),
+             ...);
+        }(std::make_index_sequence<field_count>());
+        result[field_count] = (offset + cache_line - 1) / cache_line * cache_line;
+        return result;
+    }();
+
+public:
+    /// Size of a tile, in bytes.
+    static constexpr std::size_t tile_bytes = offsets[field_count];
+
+private:
+    /// Number of cache lines per tile.
+    static constexpr std::size_t tile_lines = tile_bytes / cache_line;
+
+    /// Relocating a tile relocates each field.
+    static constexpr bool trivially_relocatable = []<typename... Fs>(std::tuple<Fs...> *) {
+        return (is_trivially_relocatable_v<Fs> && ...);
+    }(static_cast<field_types *>(nullptr));
+
+    /// Buffer of tiles, or nullptr.
+    line_t *_tiles;
+
+    /// Number of live values.
+    std::size_t _size;
+
+    /// Number of tiles in the buffer.
+    std::size_t _tile_capacity;
+
+    /// Memory allocator.
+    [[no_unique_address]] line_allocator _allocator;
+
+    /// Returns the number of tiles holding count values.
+    static constexpr std::size_t tiles_for(std::size_t count) noexcept {
+        return (count + Lanes - 1) / Lanes;
+    }
+
+    /// Returns the array of field K in a tile, constant if the tile is.
+    template<std::size_t K, typename Line>
+    static auto *field_of(Line *tile) noexcept {
+        constexpr bool is_const = std::is_const_v<Line>;
+        using F = std::conditional_t<is_const, field_type<K> const, field_type<K>>;
+        using byte = std::conditional_t<is_const, std::byte const, std::byte>;
+        return std::assume_aligned<field_alignment<K>>(
+            reinterpret_cast<F *>(reinterpret_cast<byte *>(tile) + offsets[K]));
+    }
+
+    /// Tuples of references to fields.
+    template<typename Fields>
+    struct references_of;
+
+    template<typename... Fs>
+    struct references_of<std::tuple<Fs...>> {
+        using type = std::tuple<Fs &...>;
+        using const_type = std::tuple<Fs const &...>;
+    };
+
+    /// Returns the slot of field K of value i.
+    template<std::size_t K>
+    field_type<K> *slot(std::size_t i) noexcept {
+        return field_of<K>(_tiles + i / Lanes * tile_lines) + i % Lanes;
+    }
+
+    /// Returns the constant slot of field K of value i.
+    template<std::size_t K>
+    field_type<K> const *slot(std::size_t i) const noexcept {
+        line_t const *const tiles = _tiles;
+        return field_of<K>(tiles + i / Lanes * tile_lines) + i % Lanes;
+    }
+
+    /// Destroys[1] the first count fields of value i.
+    void destroy_value(std::size_t i, std::size_t count) noexcept {
+        for_each_field([&](auto k) {
+            if constexpr (!std::is_trivially_destructible_v<field_type<k>>) {
+                if (k < count)
+                    alloc_traits::destroy(_allocator, slot<k>(i));
+            }
+        });
+    }
+
+    /// Constructs the fields of value i from one argument per field, or
+    /// value-initializes them if there are no arguments. If a constructor
+    /// throws, the fields already constructed are destroyed.
+    template<typename... Args>
+    void construct_value(std::size_t i, Args &&...args) {
+        static_assert(sizeof...(Args) == 0 || sizeof...(Args) == field_count,
+                      "aosoa_vector_t: a value takes one argument per field");
+        auto arguments = std::forward_as_tuple(std::forward<Args>(args)...);
+        std::size_t constructed = 0;
+        try {
+            for_each_field([&](auto k) {
+                if constexpr (sizeof...(Args) == 0) {
+                    alloc_traits::construct(_allocator, slot<k>(i));
+                } else {
+                    alloc_traits::construct(_allocator, slot<k>(i),
+                                            std::get<k>(std::move(arguments)));
+                }
+                constructed++;
+            });
+        } catch (...) {
+            destroy_value(i, constructed);
+            throw;
+        }
+    }
+
+    /// Value-initializes[1] the values of rank _size to new_size - 1. The
+    /// buffer must be large enough.
+    void construct_tail(std::size_t new_size) {
+        for (; _size < new_size; _size++) {
+            construct_value(_size);
+        }
+    }
+
+    /// Destroys[1] the values of rank new_size to _size - 1.
+    void destroy_tail(std::size_t new_size) noexcept {
+        for (; _size > new_size; _size--) {
+            destroy_value(_size - 1, field_count);
+        }
+    }
+
+    /// Destroys every value and deallocates the buffer, leaving the vector
+    /// empty with no capacity.
+    void release() noexcept {
+        if (_tiles) {
+            destroy_tail(0);
+            alloc_traits::deallocate(_allocator, _tiles, _tile_capacity * tile_lines);
+        }
+        _tiles = nullptr;
+        _size = 0;
+        _tile_capacity = 0;
+    }
+
+    /// Takes ownership of the buffer of other, leaving it empty.
+    /// The current buffer must have been released beforehand.
+    void steal(aosoa_vector_t &other) noexcept {
+        _tiles = std::exchange(other._tiles, nullptr);
+        _size = std::exchange(other._size, 0);
+        _tile_capacity = std::exchange(other._tile_capacity, 0);
+    }
+
+    /// Copies or moves the values of other one by one, after the live ones.
+    template<typename Other>
+    void construct_values(Other &&other) {
+        reserve(_size + other._size);
+        for (std::size_t i = 0; i < other._size; i++) {
+            std::apply([&](auto &...fields) {
+                if constexpr (std::is_rvalue_reference_v<Other &&>)
+                    construct_value(_size, std::move(fields)...);
+                else
+                    construct_value(_size, fields...);
+            }, other[i]);
+            _size++;
+        }
+    }
+
+    /// Moves the live values to a buffer of new_tile_capacity tiles and
+    /// releases the old one. The used tiles are copied with a single memcpy
+    /// if every field is trivially relocatable, otherwise the fields are
+    /// moved one by one, then destroyed[1].
+    void relocate(std::size_t new_tile_capacity) {
+        line_t *new_tiles = alloc_traits::allocate(_allocator, new_tile_capacity * tile_lines);
+        if constexpr (trivially_relocatable) {
+            if (_size)
+                std::memcpy(static_cast<void *>(new_tiles), static_cast<void const *>(_tiles),
+                            tiles_for(_size) * tile_bytes);
+        } else {
+            for_each_field([&](auto k) {
+                using F = field_type<k>;
+                for (std::size_t i = 0; i < _size; i++) {
+                    F *const target = field_of<k>(new_tiles + i / Lanes * tile_lines) + i % Lanes;
+                    alloc_traits::construct(_allocator, target, std::move(*slot<k>(i)));
+                    if constexpr (!std::is_trivially_destructible_v<F>)
+                        alloc_traits::destroy(_allocator, slot<k>(i));
+                }
+            });
+        }
+        if (_tiles)
+            alloc_traits::deallocate(_allocator, _tiles, _tile_capacity * tile_lines);
+        _tiles = new_tiles;
+        _tile_capacity = new_tile_capacity;
+    }
+
+public:
+    /// View of the fields of the values of a tile.
+    template<bool Const>
+    struct tile_t {
+    private:
+        friend aosoa_vector_t;
+
+        using tile_pointer = std::conditional_t<Const, line_t const, line_t> *;
+
+        tile_pointer _tile = nullptr;
+        std::size_t _size = 0;
+
+        tile_t(tile_pointer tile, std::size_t size) noexcept : _tile(tile), _size(size) {}
+
+    public:
+        tile_t() noexcept = default;
+
+        /// Returns the number of live values in the tile: Lanes, except in
+        /// the last tile.
+        std::size_t size() const noexcept { return _size; }
+
+        /// Returns the live values of field K.
+        template<std::size_t K>
+        auto column() const noexcept {
+            return std::span(field_of<K>(_tile), _size);
+        }
+
+        /// Returns the live values of the field Member points to, eg.
+        /// col<&particle_t::x>().
+        template<auto Member>
+        auto col() const noexcept {
+            constexpr std::size_t k = soa_detail::field_index<T, Member>();
+            static_assert(k < field_count, "aosoa_vector_t: not a field of T");
+            return column<k>();
+        }
+    };
+
+    /// Random access iterator over the tiles, whose reference is a tile_t
+    /// view.
+    template<bool Const>
+    struct tile_iterator_t {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = tile_t<Const>;
+        using difference_type = std::ptrdiff_t;
+        using reference = tile_t<Const>;
+
+    private:
+        friend aosoa_vector_t;
+
+        using tile_pointer = typename tile_t<Const>::tile_pointer;
+
+        tile_pointer _tiles = nullptr;
+        std::size_t _index = 0;
+        std::size_t _size = 0;
+
+        tile_iterator_t(tile_pointer tiles, std::size_t index, std::size_t size) noexcept
+            : _tiles(tiles), _index(index), _size(size) {}
+
+    public:
+        tile_iterator_t() noexcept = default;
+
+        tile_t<Const> operator*() const noexcept {
+            return {_tiles + _index * tile_lines, std::min(Lanes, _size - _index * Lanes)};
+        }
+
+        tile_t<Const> operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        tile_iterator_t &operator++() noexcept { return _index++, *this; }
+
+        tile_iterator_t operator++(int) noexcept {
+            tile_iterator_t it = *this;
+            ++*this;
+            return it;
+        }
+
+        tile_iterator_t &operator--() noexcept { return _index--, *this; }
+
+        tile_iterator_t operator--(int) noexcept {
+            tile_iterator_t it = *this;
+            --*this;
+            return it;
+        }
+
+        tile_iterator_t &operator+=(difference_type n) noexcept {
+            _index += std::size_t(n);
+            return *this;
+        }
+
+        tile_iterator_t &operator-=(difference_type n) noexcept { return *this += -n; }
+
+        friend tile_iterator_t operator+(tile_iterator_t it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend tile_iterator_t operator+(difference_type n, tile_iterator_t it) noexcept {
+            return it += n;
+        }
+        friend tile_iterator_t operator-(tile_iterator_t it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(tile_iterator_t const &a,
+                                         tile_iterator_t const &b) noexcept {
+            return difference_type(a._index - b._index);
+        }
+
+        friend bool operator==(tile_iterator_t const &a, tile_iterator_t const &b) noexcept {
+            return a._index == b._index;
+        }
+
+        friend auto operator<=>(tile_iterator_t const &a, tile_iterator_t const &b) noexcept {
+            return a._index <=> b._index;
+        }
+    };
+
+    using tile = tile_t<false>;
+    using const_tile = tile_t<true>;
+    using tile_iterator = tile_iterator_t<false>;
+    using const_tile_iterator = tile_iterator_t<true>;
+
+    /// Fields of a value, as a tuple of references.
+    using reference = typename references_of<field_types>::type;
+    using const_reference = typename references_of<field_types>::const_type;
+
+    /// Initializes an empty vector with no capacity.
+    aosoa_vector_t() noexcept(noexcept(Allocator()))
+        : _tiles(nullptr), _size(0), _tile_capacity(0), _allocator() {}
+
+    explicit aosoa_vector_t(Allocator const &alloc) noexcept
+        : _tiles(nullptr), _size(0), _tile_capacity(0), _allocator(alloc) {}
+
+    /// Initializes a vector of s value-initialized[1] values.
+    explicit aosoa_vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : aosoa_vector_t(alloc) {
+        resize(s);
+    }
+
+    //copy constructor
+    aosoa_vector_t(aosoa_vector_t const &other)
+        : aosoa_vector_t(Allocator(alloc_traits::select_on_container_copy_construction(
+              other._allocator))) {
+        construct_values(other);
+    }
+
+    //move constructor
+    aosoa_vector_t(aosoa_vector_t &&other) noexcept
+        : _tiles(nullptr), _size(0), _tile_capacity(0), _allocator(std::move(other._allocator)) {
+        steal(other);
+    }
+
+    //copy assignment operator: the current buffer is reused if it is large
+    //enough
+    aosoa_vector_t &operator=(aosoa_vector_t const &other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            //the current buffer belongs to the old allocator
+            if (!alloc_traits::is_always_equal::value && _allocator != other._allocator)
+                release();
+            _allocator = other._allocator;
+        }
+        construct_values(other);
+        return *this;
+    }
+
+    //Move assignment operator
+    aosoa_vector_t &operator=(aosoa_vector_t &&other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other)
+            return *this;
+        release();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            _allocator = std::move(other._allocator);
+        } else if (!alloc_traits::is_always_equal::value &&
+                   _allocator != other._allocator) {
+            //the buffer of other cannot be handed over to our allocator
+            construct_values(std::move(other));
+            return *this;
+        }
+        steal(other);
+        return *this;
+    }
+
+    /// Exchanges the contents of two vectors. Allocators are only swapped if
+    /// they propagate on swap, otherwise they must compare equal.
+    void swap(aosoa_vector_t &other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(_allocator, other._allocator);
+        }
+        swap(_tiles, other._tiles);
+        swap(_size, other._size);
+        swap(_tile_capacity, other._tile_capacity);
+    }
+
+    friend void swap(aosoa_vector_t &a, aosoa_vector_t &b) noexcept { a.swap(b); }
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return Allocator(_allocator); }
+
+    /// Returns the number of values.
+    std::size_t size() const { return _size; }
+
+    /// Returns the number of values the buffer can hold, a multiple of Lanes.
+    std::size_t capacity() const { return _tile_capacity * Lanes; }
+
+    /// Returns the number of tiles holding values.
+    std::size_t tile_count() const { return tiles_for(_size); }
+
+    /// Returns the tiles holding values.
+    std::ranges::subrange<tile_iterator> tiles() noexcept {
+        return {tile_iterator(_tiles, 0, _size), tile_iterator(_tiles, tile_count(), _size)};
+    }
+
+    /// Returns the tiles holding values.
+    std::ranges::subrange<const_tile_iterator> tiles() const noexcept {
+        return {const_tile_iterator(_tiles, 0, _size),
+                const_tile_iterator(_tiles, tile_count(), _size)};
+    }
+
+    /// Returns references to the fields of value i.
+    reference operator[](std::size_t i) noexcept {
+        return [&]<std::size_t... K>(std::index_sequence<K...>) {
+            return reference(*slot<K>(i)...);
+        }(std::make_index_sequence<field_count>());
+    }
+
+    /// Returns constant references to the fields of value i.
+    const_reference operator[](std::size_t i) const noexcept {
+        return [&]<std::size_t... K>(std::index_sequence<K...>) {
+            return const_reference(*slot<K>(i)...);
+        }(std::make_index_sequence<field_count>());
+    }
+
+    /// Returns a copy of value i, gathered from its tile.
+    T value(std::size_t i) const {
+        return std::apply([](auto const &...fields) { return T{fields...}; }, (*this)[i]);
+    }
+
+    /// Copies the fields of value into a new value at the end of the vector.
+    reference push_back(T const &value) {
+        return std::apply(
+            [this](auto const &...fields) -> reference { return emplace_back(fields...); },
+            soa_detail::tie_fields(value));
+    }
+
+    /// Moves the fields of value into a new value at the end of the vector.
+    reference push_back(T &&value) {
+        return std::apply(
+            [this](auto &...fields) -> reference { return emplace_back(std::move(fields)...); },
+            soa_detail::tie_fields(value));
+    }
+
+    /// Constructs a new value at the end of the vector from one argument per
+    /// field, and returns references to its fields. If the capacity is
+    /// insufficient, the growth policy decides of the new capacity, which is
+    /// rounded up to whole tiles.
+    template<typename... Args>
+        requires(sizeof...(Args) == field_count)
+    reference emplace_back(Args &&...args) {
+        if (_size == capacity())
+            reserve(GrowthPolicy::template next_capacity<T>(capacity()));
+        construct_value(_size, std::forward<Args>(args)...);
+        return (*this)[_size++];
+    }
+
+    /// Grows the buffer to hold new_capacity values, rounded up to whole
+    /// tiles, if it is smaller, relocating the live values. Never shrinks the
+    /// buffer.
+    void reserve(std::size_t new_capacity) {
+        if (tiles_for(new_capacity) > _tile_capacity)
+            relocate(tiles_for(new_capacity));
+    }
+
+    /// Sets the number of values, destroying or value-initializing[1] values
+    /// as necessary, and reserving memory as needed.
+    void resize(std::size_t new_size) {
+        reserve(new_size);
+        construct_tail(new_size);
+        destroy_tail(new_size);
+    }
+
+    /// Destroys the values and deallocates the buffer.
+    ~aosoa_vector_t() { release(); }
+};
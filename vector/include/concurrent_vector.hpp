@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "segmented_vector.hpp"
+
+// concurrent_vector_t ---------------------------------------------------------
+
+// concurrent_vector_t<T> is an append-only vector on which any number of
+// threads can call emplace_back() at the same time, without locks. It uses
+// the segment layout of segmented_vector_t (see segmented_vector.hpp), so
+// values never move and references to them stay valid while other threads
+// append.
+
+// emplace_back() works in three steps:
+// - a slot is claimed by incrementing _claimed with a compare-and-swap, once
+// the segment of the slot and its slot states are installed, each with a
+// compare-and-swap if no other thread did (the losers give theirs back to
+// the allocator),
+// - the value is constructed in the slot,
+// - the slot is marked ready, then the published size _size is advanced over
+// every ready slot. Any thread advances it on behalf of slower ones, so that
+// no thread ever waits for another.
+
+// Since slots are only claimed once their segment is allocated, a failed
+// allocation leaves no claimed slot behind, and the states of every claimed
+// slot are visible to the threads that see it claimed: _claimed is loaded
+// with acquire semantics after the states were installed.
+
+// Readers only look at the first size() values, which are all fully
+// constructed: size() is loaded with acquire semantics, and every slot state
+// was stored before _size moved past it. A value whose slot was claimed but
+// is not constructed yet holds back the published size, but never blocks the
+// writers.
+
+// Two writers finishing neighbouring slots each store their own state, then
+// load the other's. With acquire and release semantics, both loads could miss
+// the other store, and neither writer would publish the later slot: slots are
+// claimed, marked and published with sequentially consistent operations, so
+// that at least one of the writers sees both slots ready. Slot states are
+// never inferred from a missing table, which would escape that order.
+
+// If a constructor throws, the exception propagates and the slot is marked
+// failed: the published size moves past it, but it holds no value. Readers
+// that may race with throwing constructors check holds_value() before
+// looking at a value.
+
+// Only emplace_back(), reserve(), size() and element access may be called
+// concurrently. The allocator must be usable from several threads at once,
+// like std::allocator. A concurrent_vector_t can be neither copied nor moved,
+// since other threads may hold references to it and to its values.
+
+template<typename T, typename Allocator = std::allocator<T>, std::size_t FirstSegment = 16>
+struct concurrent_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    /// Number of entries of the segment table.
+    static constexpr std::size_t max_segments = segment_layout_t<FirstSegment>::max_segments;
+
+private:
+    using layout = segment_layout_t<FirstSegment>;
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    /// State of a claimed slot.
+    enum slot_state_t : unsigned char { pending, ready, failed };
+
+    using state_allocator_t =
+        typename alloc_traits::template rebind_alloc<std::atomic<slot_state_t>>;
+    using state_traits = std::allocator_traits<state_allocator_t>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "concurrent_vector_t: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T *>,
+                  "concurrent_vector_t: fancy pointers are not supported");
+
+    /// Segment table, holding nullptr for segments that are not allocated.
+    std::atomic<T *> _segments[max_segments] = {};
+
+    /// Slot states of the values of each segment, allocated alongside.
+    std::atomic<std::atomic<slot_state_t> *> _states[max_segments] = {};
+
+    /// Number of claimed slots.
+    std::atomic<std::size_t> _claimed{0};
+
+    /// Published size: the first _size values are alive.
+    std::atomic<std::size_t> _size{0};
+
+    /// Memory allocator.
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Returns segment k, allocating it if no other thread did.
+    T *values_of(std::size_t k) {
+        T *segment = _segments[k].load(std::memory_order_acquire);
+        if (segment)
+            return segment;
+        T *fresh = alloc_traits::allocate(_allocator, layout::segment_size(k));
+        if (_segments[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire))
+            return fresh;
+        //another thread installed the segment first
+        alloc_traits::deallocate(_allocator, fresh, layout::segment_size(k));
+        return segment;
+    }
+
+    /// Returns the slot states of segment k, allocating them if no other
+    /// thread did.
+    std::atomic<slot_state_t> *states_of(std::size_t k) {
+        std::atomic<slot_state_t> *states = _states[k].load(std::memory_order_acquire);
+        if (states)
+            return states;
+        state_allocator_t state_allocator(_allocator);
+        std::size_t const n = layout::segment_size(k);
+        std::atomic<slot_state_t> *fresh = state_traits::allocate(state_allocator, n);
+        for (std::size_t i = 0; i < n; i++) {
+            state_traits::construct(state_allocator, fresh + i, pending);
+        }
+        if (_states[k].compare_exchange_strong(states, fresh, std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+            return fresh;
+        //another thread installed the states first
+        state_traits::deallocate(state_allocator, fresh, n);
+        return states;
+    }
+
+    /// Returns the state of slot i, which must be claimed, so that its states
+    /// are installed.
+    slot_state_t state_of(std::size_t i) const noexcept {
+        std::size_t const k = layout::segment_of(i);
+        std::atomic<slot_state_t> const *states = _states[k].load(std::memory_order_acquire);
+        return states[i - layout::segment_start(k)].load(std::memory_order_seq_cst);
+    }
+
+    /// Advances the published size over the slots that are ready or failed.
+    void publish() noexcept {
+        std::size_t published = _size.load(std::memory_order_seq_cst);
+        while (published < _claimed.load(std::memory_order_seq_cst)) {
+            if (state_of(published) == pending)
+                return;
+            //on failure, published is reloaded and the loop goes on from there
+            if (_size.compare_exchange_weak(published, published + 1, std::memory_order_seq_cst))
+                published++;
+        }
+    }
+
+    /// Address of the value of index i, whose segment must be allocated.
+    T *slot(std::size_t i) const noexcept {
+        std::size_t const k = layout::segment_of(i);
+        return _segments[k].load(std::memory_order_acquire) + (i - layout::segment_start(k));
+    }
+
+public:
+    /// Initializes an empty vector with no segment.
+    concurrent_vector_t() noexcept(noexcept(Allocator())) : _allocator() {}
+
+    explicit concurrent_vector_t(Allocator const &alloc) noexcept : _allocator(alloc) {}
+
+    concurrent_vector_t(concurrent_vector_t const &) = delete;
+    concurrent_vector_t &operator=(concurrent_vector_t const &) = delete;
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Returns the published size: the values of index 0 to size() - 1 are
+    /// all fully constructed, and visible to the calling thread.
+    std::size_t size() const noexcept { return _size.load(std::memory_order_acquire); }
+
+    /// Returns the number of segments holding published values.
+    std::size_t segment_count() const noexcept {
+        std::size_t const s = size();
+        return s == 0 ? 0 : layout::segment_of(s - 1) + 1;
+    }
+
+    /// Tells whether the published value of index i was constructed, which
+    /// is false only if its constructor threw.
+    bool holds_value(std::size_t i) const noexcept { return state_of(i) == ready; }
+
+    /// Returns the published values of segment k, which are contiguous, or
+    /// an empty span if k >= segment_count(). Failed slots are included: see
+    /// holds_value().
+    std::span<T> segment(std::size_t k) noexcept {
+        std::size_t const s = size();
+        if (s == 0 || k > layout::segment_of(s - 1))
+            return {};
+        std::size_t const start = layout::segment_start(k);
+        return {_segments[k].load(std::memory_order_acquire),
+                std::min(s - start, layout::segment_size(k))};
+    }
+
+    /// Returns the published values of segment k, which are contiguous, or
+    /// an empty span if k >= segment_count(). Failed slots are included: see
+    /// holds_value().
+    std::span<T const> segment(std::size_t k) const noexcept {
+        std::size_t const s = size();
+        if (s == 0 || k > layout::segment_of(s - 1))
+            return {};
+        std::size_t const start = layout::segment_start(k);
+        return {_segments[k].load(std::memory_order_acquire),
+                std::min(s - start, layout::segment_size(k))};
+    }
+
+    /// Non-const element access, for i < size() or for values returned by
+    /// emplace_back().
+    T &operator[](std::size_t i) noexcept { return *slot(i); }
+
+    /// Read-only element access, for i < size() or for values returned by
+    /// emplace_back().
+    T const &operator[](std::size_t i) const noexcept { return *slot(i); }
+
+    /// Constructs a new element at the end of the vector, and returns it.
+    /// Can be called from any number of threads at once. The value is
+    /// published once every value appended before it is constructed, or
+    /// failed to be. Throws std::bad_alloc if the segment table is full.
+    template<typename... Args>
+    T &emplace_back(Args &&...args) {
+        std::size_t i = _claimed.load(std::memory_order_seq_cst);
+        std::size_t k;
+        T *values;
+        std::atomic<slot_state_t> *states;
+        do {
+            //on failure, i is reloaded and its segment checked again
+            k = layout::segment_of(i);
+            if (k >= max_segments)
+                throw std::bad_alloc();
+            values = values_of(k);
+            states = states_of(k);
+        } while (!_claimed.compare_exchange_weak(i, i + 1, std::memory_order_seq_cst));
+        std::size_t const offset = i - layout::segment_start(k);
+        T *const value = values + offset;
+        std::atomic<slot_state_t> *const state = states + offset;
+        try {
+            alloc_traits::construct(_allocator, value, std::forward<Args>(args)...);
+        } catch (...) {
+            //the slot is skipped, so that it does not hold back the others
+            state->store(failed, std::memory_order_seq_cst);
+            publish();
+            throw;
+        }
+        state->store(ready, std::memory_order_seq_cst);
+        publish();
+        return *value;
+    }
+
+    /// Allocates the segments holding the first new_capacity values, so that
+    /// appending them never allocates. Can be called concurrently with
+    /// emplace_back().
+    void reserve(std::size_t new_capacity) {
+        for (std::size_t k = 0; k < max_segments && layout::segment_start(k) < new_capacity;
+             k++) {
+            values_of(k);
+            states_of(k);
+        }
+    }
+
+    /// Destroys the values and deallocates the segments. No other thread may
+    /// use the vector anymore.
+    ~concurrent_vector_t() {
+        state_allocator_t state_allocator(_allocator);
+        for (std::size_t k = 0; k < max_segments; k++) {
+            T *values = _segments[k].load(std::memory_order_acquire);
+            std::atomic<slot_state_t> *states = _states[k].load(std::memory_order_acquire);
+            std::size_t const n = layout::segment_size(k);
+            if (!std::is_trivially_destructible_v<T> && values && states) {
+                for (std::size_t i = 0; i < n; i++) {
+                    if (states[i].load(std::memory_order_relaxed) == ready)
+                        alloc_traits::destroy(_allocator, values + i);
+                }
+            }
+            if (values)
+                alloc_traits::deallocate(_allocator, values, n);
+            if (states)
+                state_traits::deallocate(state_allocator, states, n);
+        }
+    }
+};
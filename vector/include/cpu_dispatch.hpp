@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+
+// CPU dispatch ----------------------------------------------------------------
+
+// Vectorized algorithms must run on machines with different instruction sets,
+// from a build that only assumes the baseline one. Their kernels are compiled
+// once per level with the target attribute of the level's instruction set
+// (see simd.hpp), and one of them is picked at run time:
+// - detected_simd_level() is the widest level supported by the CPU and the
+// operating system, which is queried once with __builtin_cpu_supports,
+// - simd_level() is the level in use: the detected one, unless the
+// VECTOR_T_SIMD environment variable names a narrower one (scalar, sse2,
+// avx2 or avx512), which is useful to compare levels in benchmarks,
+// - simd_dispatch_t holds a pointer to the kernel of each level, and calls
+// the one of simd_level() unless another level is asked for.
+
+// Levels wider than the detected one are never used: asking for one gives
+// the detected level, so that forcing a level cannot crash the program on an
+// illegal instruction.
+
+// GNU ifuncs would spare the indirect call, but their resolvers must be named
+// functions, which kernels templated on the value type are not.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_T_SIMD_X86 1
+#else
+#define VECTOR_T_SIMD_X86 0
+#endif
+
+/// Instruction sets kernels are compiled for, from the narrowest to the
+/// widest.
+enum struct simd_level_t { scalar, sse2, avx2, avx512 };
+
+/// Number of levels.
+inline constexpr std::size_t simd_level_count = 4;
+
+/// Returns the lowercase name of level.
+constexpr char const *simd_level_name(simd_level_t level) noexcept {
+    switch (level) {
+    case simd_level_t::sse2:
+        return "sse2";
+    case simd_level_t::avx2:
+        return "avx2";
+    case simd_level_t::avx512:
+        return "avx512";
+    case simd_level_t::scalar:
+        break;
+    }
+    return "scalar";
+}
+
+/// Returns the level named name, if any.
+constexpr std::optional<simd_level_t> parse_simd_level(std::string_view name) noexcept {
+    for (std::size_t l = 0; l < simd_level_count; l++) {
+        if (name == simd_level_name(simd_level_t(l)))
+            return simd_level_t(l);
+    }
+    return std::nullopt;
+}
+
+/// Returns the widest level supported by the CPU and the operating system.
+inline simd_level_t detected_simd_level() noexcept {
+#if VECTOR_T_SIMD_X86
+    static simd_level_t const level = [] {
+        __builtin_cpu_init();
+        //8 and 16 bits lanes need AVX-512BW
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return simd_level_t::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return simd_level_t::avx2;
+        if (__builtin_cpu_supports("sse2"))
+            return simd_level_t::sse2;
+        return simd_level_t::scalar;
+    }();
+    return level;
+#else
+    return simd_level_t::scalar;
+#endif
+}
+
+/// Returns the level in use: the detected one, or the one named by the
+/// VECTOR_T_SIMD environment variable if it is narrower. Unknown names are
+/// reported on stderr and ignored.
+inline simd_level_t simd_level() noexcept {
+    static simd_level_t const level = [] {
+        simd_level_t const detected = detected_simd_level();
+        char const *forced = std::getenv("VECTOR_T_SIMD");
+        if (!forced)
+            return detected;
+        if (std::optional<simd_level_t> const parsed = parse_simd_level(forced))
+            return std::min(*parsed, detected);
+        std::fprintf(stderr, "VECTOR_T_SIMD: unknown level \"%s\", using %s\n", forced,
+                     simd_level_name(detected));
+        return detected;
+    }();
+    return level;
+}
+
+/// Kernel with the given signature, compiled for each level.
+template<typename Signature>
+struct simd_dispatch_t;
+
+template<typename R, typename... Args>
+struct simd_dispatch_t<R(Args...)> {
+public:
+    using kernel_t = R (*)(Args...);
+
+private:
+    /// Kernel of each level, from the narrowest to the widest.
+    kernel_t _kernels[simd_level_count];
+
+public:
+    /// Initializes the kernels of each level. Levels without a kernel use the
+    /// one of the level below, so that only the scalar kernel is needed on
+    /// architectures without vector kernels.
+    explicit simd_dispatch_t(kernel_t scalar, kernel_t sse2 = nullptr, kernel_t avx2 = nullptr,
+                             kernel_t avx512 = nullptr) noexcept
+        : _kernels{scalar, sse2, avx2, avx512} {
+        for (std::size_t l = 1; l < simd_level_count; l++) {
+            if (!_kernels[l])
+                _kernels[l] = _kernels[l - 1];
+        }
+    }
+
+    /// Returns the kernel of level, or of the detected level if it is
+    /// narrower.
+    kernel_t at(simd_level_t level) const noexcept {
+        return _kernels[std::size_t(std::min(level, detected_simd_level()))];
+    }
+
+    /// Calls the kernel of simd_level().
+    R operator()(Args... args) const { return at(simd_level())(args...); }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// inplace_vector_t ------------------------------------------------------------
+
+// inplace_vector_t<T, N> is a vector whose capacity is fixed to N at compile
+// time, and whose values are stored inside the object: it never allocates, and
+// has no allocator at all. It is meant for real-time code paths, where running
+// out of room must be handled instead of triggering a heap allocation.
+
+// It follows the lifetime rules of vector_t (see vector.hpp): _size holds the
+// number of values that are alive, the storage past _size is uninitialized,
+// and values are constructed with std::construct_at and destroyed with
+// std::destroy_at. The storage is an array wrapped in an anonymous union, so
+// that no value is constructed until it is emplaced.
+
+// The special member functions are trivial when the corresponding operations
+// of T are, which makes inplace_vector_t trivially copyable when T is.
+// Everything is constexpr, so inplace_vector_t can be used in constant
+// expressions.
+
+// Unlike vector_t, moving an inplace_vector_t has to move the values one by
+// one, and leaves the moved-from vector with the same number of moved-from
+// values.
+
+template<typename T, std::size_t N>
+struct inplace_vector_t {
+public:
+    using value_type = T;
+
+private:
+    /// Storage for N values, of which the first _size are alive.
+    union {
+        T _values[N];
+    };
+
+    /// Size of the vector.
+    /// Holds the number of alive values.
+    std::size_t _size = 0;
+
+    /// Destroys the values of rank new_size to _size - 1.
+    constexpr void destroy_tail(std::size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; _size > new_size; _size--) {
+                std::destroy_at(_values + _size - 1);
+            }
+        }
+        if (new_size < _size)
+            _size = new_size;
+    }
+
+    /// Assigns the values of other over the live values, then constructs or
+    /// destroys the remaining ones.
+    template<typename Other>
+    constexpr void assign_values(Other &&other) {
+        std::size_t const common = _size < other._size ? _size : other._size;
+        for (std::size_t i = 0; i < common; i++) {
+            _values[i] = std::forward<Other>(other)._values[i];
+        }
+        for (; _size < other._size; _size++) {
+            std::construct_at(_values + _size, std::forward<Other>(other)._values[_size]);
+        }
+        destroy_tail(other._size);
+    }
+
+public:
+    /// Initializes an empty vector.
+    /// Constant expressions cannot hold uninitialized values, so the storage
+    /// of trivial values is zeroed when evaluated at compile time. Trivial
+    /// values have no observable lifetime, and the storage is left untouched at
+    /// run time.
+    constexpr inplace_vector_t() noexcept {
+        if constexpr (std::is_trivial_v<T>) {
+            if (std::is_constant_evaluated()) {
+                for (std::size_t i = 0; i < N; i++) {
+                    std::construct_at(_values + i);
+                }
+            }
+        }
+    }
+
+    /// Initializes a vector of s value-initialized values.
+    /// Throws std::bad_alloc if s exceeds N.
+    constexpr explicit inplace_vector_t(std::size_t s) : inplace_vector_t() { resize(s); }
+
+    //copy constructor
+    constexpr inplace_vector_t(inplace_vector_t const &)
+        requires std::is_trivially_copy_constructible_v<T>
+    = default;
+
+    constexpr inplace_vector_t(inplace_vector_t const &other) {
+        for (; _size < other._size; _size++) {
+            std::construct_at(_values + _size, other._values[_size]);
+        }
+    }
+
+    //move constructor
+    constexpr inplace_vector_t(inplace_vector_t &&)
+        requires std::is_trivially_move_constructible_v<T>
+    = default;
+
+    constexpr inplace_vector_t(inplace_vector_t &&other) noexcept(
+        std::is_nothrow_move_constructible_v<T>) {
+        for (; _size < other._size; _size++) {
+            std::construct_at(_values + _size, std::move(other._values[_size]));
+        }
+    }
+
+    //copy assignment operator
+    constexpr inplace_vector_t &operator=(inplace_vector_t const &)
+        requires std::is_trivially_copy_assignable_v<T> &&
+                 std::is_trivially_copy_constructible_v<T> &&
+                 std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr inplace_vector_t &operator=(inplace_vector_t const &other) {
+        if (this != &other)
+            assign_values(other);
+        return *this;
+    }
+
+    //Move assignment operator
+    constexpr inplace_vector_t &operator=(inplace_vector_t &&)
+        requires std::is_trivially_move_assignable_v<T> &&
+                 std::is_trivially_move_constructible_v<T> &&
+                 std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr inplace_vector_t &operator=(inplace_vector_t &&other) noexcept(
+        std::is_nothrow_move_assignable_v<T> &&
+        std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other)
+            assign_values(std::move(other));
+        return *this;
+    }
+
+    /// Returns a pointer as an iterator to the beginning of the vector.
+    constexpr T *begin() noexcept { return _values; }
+
+    /// Returns a pointer as an iterator to the end of the vector.
+    constexpr T *end() noexcept { return _values + _size; }
+
+    /// Returns a constant pointer as an iterator to the beginning of the vector.
+    constexpr T const *begin() const noexcept { return _values; }
+
+    /// Returns a constant pointer as an iterator to the end of the vector.
+    constexpr T const *end() const noexcept { return _values + _size; }
+
+    /// Returns the size of the vector.
+    constexpr std::size_t size() const noexcept { return _size; }
+
+    /// Returns the capacity of the vector, which is always N.
+    static constexpr std::size_t capacity() noexcept { return N; }
+
+    /// Non-const element access for getting and modifying elements.
+    constexpr T &operator[](std::size_t i) { return _values[i]; }
+
+    /// Read-only element access.
+    constexpr T const &operator[](std::size_t i) const { return _values[i]; }
+
+    /// Constructs a new element at the end of the vector, and returns a
+    /// pointer to it. If the vector is full, nothing is constructed and
+    /// nullptr is returned.
+    template<typename... Args>
+    constexpr T *try_emplace_back(Args &&...args) noexcept(
+        std::is_nothrow_constructible_v<T, Args...>) {
+        if (_size == N)
+            return nullptr;
+        T *value = std::construct_at(_values + _size, std::forward<Args>(args)...);
+        _size++;
+        return value;
+    }
+
+    /// Constructs a new element at the end of the vector.
+    /// Throws std::bad_alloc if the vector is full.
+    template<typename... Args>
+    constexpr T &emplace_back(Args &&...args) {
+        if (_size == N)
+            throw std::bad_alloc();
+        return *try_emplace_back(std::forward<Args>(args)...);
+    }
+
+    /// Does nothing, since the capacity is fixed.
+    /// Throws std::bad_alloc if new_capacity exceeds N.
+    static constexpr void reserve(std::size_t new_capacity) {
+        if (new_capacity > N)
+            throw std::bad_alloc();
+    }
+
+    /// Sets the size of the vector, destroying or value-initializing values as
+    /// necessary. Throws std::bad_alloc if new_size exceeds N.
+    constexpr void resize(std::size_t new_size) {
+        reserve(new_size);
+        for (; _size < new_size; _size++) {
+            std::construct_at(_values + _size);
+        }
+        destroy_tail(new_size);
+    }
+
+    //destructor
+    constexpr ~inplace_vector_t()
+        requires std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr ~inplace_vector_t() { destroy_tail(0); }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocator_extensions.hpp"
+
+#if defined(__linux__)
+#include <malloc.h>
+#endif
+
+// malloc_allocator_t ----------------------------------------------------------
+
+// Allocator drawing its memory from std::malloc instead of operator new. Since
+// std::realloc is allowed on these buffers, it provides the reallocate()
+// extension documented in allocator_extensions.hpp: vector_t uses it to grow buffers of
+// trivially relocatable values in place whenever the C library can extend the
+// block, and lets it copy the bytes otherwise.
+
+// On Linux, it also implements the allocate_at_least() and
+// reallocate_at_least() extensions with malloc_usable_size(), so that vector_t
+// uses the slack left by malloc size classes as capacity.
+
+template<typename T>
+struct malloc_allocator_t {
+    using value_type = T;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "malloc_allocator_t: over-aligned types are not supported");
+
+    malloc_allocator_t() noexcept = default;
+
+    template<typename U>
+    malloc_allocator_t(malloc_allocator_t<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        void *p = std::malloc(n * sizeof(T));
+        if (!p)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t) noexcept { std::free(p); }
+
+    /// Returns the number of values that fit in the buffer p, which was
+    /// allocated for n values.
+    static std::size_t usable_count([[maybe_unused]] T *p, [[maybe_unused]] std::size_t n) noexcept {
+#if defined(__linux__)
+        return malloc_usable_size(static_cast<void *>(p)) / sizeof(T);
+#else
+        return n;
+#endif
+    }
+
+    /// Allocates a buffer for at least n values, and reports its actual size.
+    allocation_result_t<T> allocate_at_least(std::size_t n) {
+        T *p = allocate(n);
+        return {p, usable_count(p, n)};
+    }
+
+    /// Same as reallocate(), but also reports the actual size of the buffer.
+    allocation_result_t<T> reallocate_at_least(T *p, std::size_t old_n, std::size_t new_n) {
+        T *new_p = reallocate(p, old_n, new_n);
+        return {new_p, usable_count(new_p, new_n)};
+    }
+
+    /// Resizes the buffer p, holding old_n values, to hold new_n values. The
+    /// first min(old_n, new_n) values are kept byte for byte, which means this
+    /// can only be used on trivially relocatable values. On failure, p is left
+    /// untouched.
+    T *reallocate(T *p, std::size_t, std::size_t new_n) {
+        if (new_n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        void *new_p = std::realloc(static_cast<void *>(p), new_n * sizeof(T));
+        if (!new_p)
+            throw std::bad_alloc();
+        return static_cast<T *>(new_p);
+    }
+
+    bool operator==(malloc_allocator_t const &) const noexcept { return true; }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "allocator_extensions.hpp"
+#include "malloc_allocator.hpp"
+
+#if !defined(__linux__)
+#error "mmap_allocator_t relies on the Linux-specific mremap system call"
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// mmap_allocator_t ------------------------------------------------------------
+
+// Allocator for vectors that may grow to many megabytes. Buffers smaller than
+// Threshold bytes are handled by malloc_allocator_t, while larger ones are
+// backed by anonymous private mappings.
+
+// The point is the reallocate_at_least() extension documented in
+// allocator_extensions.hpp, which vector_t uses for trivially relocatable values: mapped buffers are
+// grown with mremap(MREMAP_MAYMOVE), which moves page table entries around
+// instead of copying the values, so growing a buffer of several gigabytes
+// costs about the same as growing one of a few megabytes. Values that are not
+// trivially relocatable still benefit from page-granular capacities, but are
+// relocated one by one.
+
+// Whether a buffer is mapped only depends on its capacity, which is why
+// allocate_at_least() never reports a malloc'd capacity that reaches the
+// threshold: vector_t gives back that exact capacity to deallocate().
+
+template<typename T, std::size_t Threshold = std::size_t(4) << 20>
+struct mmap_allocator_t {
+    using value_type = T;
+
+    static_assert(Threshold >= sizeof(T),
+                  "mmap_allocator_t: the threshold must fit at least one value");
+
+    template<typename U>
+    struct rebind {
+        using other = mmap_allocator_t<U, Threshold>;
+    };
+
+private:
+    using small_allocator_t = malloc_allocator_t<T>;
+
+    /// Tells whether a buffer of n values is mapped.
+    static bool is_mapped(std::size_t n) noexcept { return n * sizeof(T) >= Threshold; }
+
+    /// Size of the mapping holding n values.
+    static std::size_t mapping_size(std::size_t n) noexcept {
+        std::size_t const page_size = std::size_t(sysconf(_SC_PAGESIZE));
+        return (n * sizeof(T) + page_size - 1) / page_size * page_size;
+    }
+
+    /// Largest malloc'd capacity.
+    static constexpr std::size_t max_small_count = (Threshold - 1) / sizeof(T);
+
+    static T *map(std::size_t n) {
+        void *p = mmap(nullptr, mapping_size(n), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+public:
+    mmap_allocator_t() noexcept = default;
+
+    template<typename U>
+    mmap_allocator_t(mmap_allocator_t<U, Threshold> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        return is_mapped(n) ? map(n) : small_allocator_t().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (is_mapped(n))
+            munmap(static_cast<void *>(p), mapping_size(n));
+        else
+            small_allocator_t().deallocate(p, n);
+    }
+
+    /// Allocates a buffer for at least n values, and reports its actual size:
+    /// the malloc slack below the threshold, whole pages above.
+    allocation_result_t<T> allocate_at_least(std::size_t n) {
+        T *p = allocate(n);
+        if (is_mapped(n))
+            return {p, mapping_size(n) / sizeof(T)};
+        std::size_t const count = small_allocator_t::usable_count(p, n);
+        return {p, count < max_small_count ? count : max_small_count};
+    }
+
+    /// Resizes the buffer p, holding old_n values, to hold at least new_n
+    /// values. Mapped buffers are remapped, which never copies the values.
+    /// Like std::realloc, this can only be used on trivially relocatable
+    /// values.
+    allocation_result_t<T> reallocate_at_least(T *p, std::size_t old_n, std::size_t new_n) {
+        if (new_n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+
+        if (!is_mapped(old_n) && !is_mapped(new_n)) {
+            T *new_p = small_allocator_t().reallocate(p, old_n, new_n);
+            std::size_t const count = small_allocator_t::usable_count(new_p, new_n);
+            return {new_p, count < max_small_count ? count : max_small_count};
+        }
+
+        if (is_mapped(old_n) && is_mapped(new_n)) {
+            void *new_p = mremap(static_cast<void *>(p), mapping_size(old_n),
+                                 mapping_size(new_n), MREMAP_MAYMOVE);
+            if (new_p == MAP_FAILED)
+                throw std::bad_alloc();
+            return {static_cast<T *>(new_p), mapping_size(new_n) / sizeof(T)};
+        }
+
+        //crossing the threshold: the values have to be copied once
+        auto const result = allocate_at_least(new_n);
+        std::size_t const kept = old_n < new_n ? old_n : new_n;
+        std::memcpy(static_cast<void *>(result.ptr), static_cast<void const *>(p),
+                    kept * sizeof(T));
+        deallocate(p, old_n);
+        return result;
+    }
+
+    bool operator==(mmap_allocator_t const &) const noexcept { return true; }
+};
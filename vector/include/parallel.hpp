@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <utility>
+
+#include "vector.hpp"
+
+// Parallel algorithms ---------------------------------------------------------
+
+// This header provides parallel versions of the loops that are usually
+// written around big vectors, for any contiguous range such as vector_t:
+// - parallel_for(range, fn) calls fn(value) on every value, and
+// parallel_for(n, fn) calls fn(begin, end) on chunks of [0, n), which keeps
+// the loop body vectorizable,
+// - parallel_transform(in, out, fn) stores fn(in[i]) in out[i],
+// - parallel_reduce(range, init, op) folds the values with an associative op,
+// - parallel_scan(in, out, op) computes the inclusive prefix sums of in,
+// - parallel_sort(range, comp) sorts the values.
+
+// The work is cut into chunks of grain values, which is the unit of
+// scheduling: large grains lower the scheduling overhead, small ones balance
+// the load better. A grain of 0 cuts the values into 256 chunks, about 8 per
+// thread on 32 threads. Chunks are handed out by recursive
+// splitting, so that idle threads steal large ranges of chunks first. The
+// order in which chunks are combined only depends on the grain, which only
+// depends on the number of values, so parallel_reduce and parallel_scan give
+// the same results on any number of threads, even for operations that are
+// not exactly associative like floating-point additions.
+
+// The algorithms run on a thread_pool_t, by default the global one which has
+// one thread per core. Each worker owns a deque of tasks: it pushes and pops
+// its own tasks at the back, while idle workers steal from the front of the
+// others' deques. The thread calling an algorithm takes part in the work
+// while waiting for it, so a pool of n threads runs n - 1 workers.
+
+// Exceptions thrown by fn are rethrown by the algorithm once every chunk is
+// done or skipped.
+
+// parallel_init(pool) returns a parallel_init_t (see vector.hpp), with which
+// vector_t constructors and resize() value-initialize huge vectors on the
+// threads of the pool.
+
+/// Work-stealing thread pool.
+struct thread_pool_t {
+public:
+    using task_t = std::function<void()>;
+
+private:
+    /// Deque of tasks, owned by a worker. The last one is shared by the
+    /// threads that do not belong to the pool.
+    struct queue_t {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    vector_t<std::unique_ptr<queue_t>> _queues;
+    vector_t<std::thread> _workers;
+
+    /// Number of tasks waiting in the deques.
+    std::atomic<std::size_t> _pending{0};
+
+    /// Number of workers waiting for tasks.
+    std::atomic<std::size_t> _sleeping{0};
+
+    std::atomic<bool> _stop{false};
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+
+    /// Pool and deque of the current thread, if it is a worker.
+    static inline thread_local thread_pool_t *_current_pool = nullptr;
+    static inline thread_local std::size_t _current_queue = 0;
+
+    /// Deque used by the current thread.
+    std::size_t own_queue() const noexcept {
+        return _current_pool == this ? _current_queue : _queues.size() - 1;
+    }
+
+    /// Pops a task from the back of deque i, or steals one from its front.
+    bool take(std::size_t i, bool steal, task_t &task) {
+        queue_t &queue = *_queues[i];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        if (steal) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        _pending.fetch_sub(1);
+        return true;
+    }
+
+    /// Takes a task from the deque of the current thread, or from the others.
+    bool find_task(task_t &task) {
+        std::size_t const own = own_queue();
+        if (take(own, false, task))
+            return true;
+        for (std::size_t n = 1; n < _queues.size(); n++) {
+            if (take((own + n) % _queues.size(), true, task))
+                return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t index) {
+        _current_pool = this;
+        _current_queue = index;
+        task_t task;
+        while (!_stop.load()) {
+            if (find_task(task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            //_sleeping is incremented before checking _pending, and submit()
+            //does the opposite, so that at least one of them sees the other
+            std::unique_lock lock(_sleep_mutex);
+            _sleeping.fetch_add(1);
+            _wake.wait(lock, [&] { return _pending.load() > 0 || _stop.load(); });
+            _sleeping.fetch_sub(1);
+        }
+    }
+
+public:
+    /// Starts a pool running on thread_count threads, including the ones
+    /// calling the algorithms: thread_count - 1 workers are started.
+    explicit thread_pool_t(std::size_t thread_count = std::thread::hardware_concurrency()) {
+        std::size_t const worker_count = thread_count > 1 ? thread_count - 1 : 0;
+        for (std::size_t i = 0; i <= worker_count; i++) {
+            _queues.emplace_back(std::make_unique<queue_t>());
+        }
+        for (std::size_t i = 0; i < worker_count; i++) {
+            _workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    thread_pool_t(thread_pool_t const &) = delete;
+    thread_pool_t &operator=(thread_pool_t const &) = delete;
+
+    /// Returns the pool used by default, with one thread per core.
+    static thread_pool_t &global() {
+        static thread_pool_t pool;
+        return pool;
+    }
+
+    /// Returns the number of threads running tasks, including the caller.
+    std::size_t thread_count() const noexcept { return _workers.size() + 1; }
+
+    /// Queues a task on the deque of the current thread.
+    void submit(task_t task) {
+        queue_t &queue = *_queues[own_queue()];
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        _pending.fetch_add(1);
+        if (_sleeping.load() > 0) {
+            //taking the lock makes sure the sleeper is either waiting or
+            //about to check _pending
+            { std::lock_guard lock(_sleep_mutex); }
+            _wake.notify_one();
+        }
+    }
+
+    /// Runs one queued task on the current thread, if there is one.
+    bool run_one() {
+        task_t task;
+        if (!find_task(task))
+            return false;
+        task();
+        return true;
+    }
+
+    /// Stops the workers once their current task is done. No task may be
+    /// waited for anymore.
+    ~thread_pool_t() {
+        {
+            std::lock_guard lock(_sleep_mutex);
+            _stop.store(true);
+        }
+        _wake.notify_all();
+        for (auto &worker : _workers) {
+            worker.join();
+        }
+    }
+};
+
+/// Set of tasks that are waited for together. The waiting thread runs queued
+/// tasks in the meantime.
+struct task_group_t {
+private:
+    thread_pool_t &_pool;
+    std::atomic<std::size_t> _running{0};
+    std::atomic<bool> _failed{false};
+    std::exception_ptr _exception;
+
+public:
+    explicit task_group_t(thread_pool_t &pool) noexcept : _pool(pool) {}
+
+    task_group_t(task_group_t const &) = delete;
+    task_group_t &operator=(task_group_t const &) = delete;
+
+    /// Returns the pool running the tasks.
+    thread_pool_t &pool() const noexcept { return _pool; }
+
+    /// Queues fn. Once a task of the group has thrown, the remaining ones
+    /// are skipped.
+    template<typename Fn>
+    void run(Fn &&fn) {
+        _running.fetch_add(1);
+        _pool.submit([this, fn = std::forward<Fn>(fn)]() mutable {
+            if (!_failed.load(std::memory_order_relaxed)) {
+                try {
+                    fn();
+                } catch (...) {
+                    //only the first exception is kept
+                    if (!_failed.exchange(true))
+                        _exception = std::current_exception();
+                }
+            }
+            _running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    /// Waits for every task, running queued ones meanwhile, and rethrows the
+    /// first exception thrown by a task.
+    void wait() {
+        while (_running.load(std::memory_order_acquire) > 0) {
+            if (!_pool.run_one())
+                std::this_thread::yield();
+        }
+        if (_failed.load())
+            std::rethrow_exception(std::exchange(_exception, nullptr));
+    }
+
+    ~task_group_t() {
+        while (_running.load(std::memory_order_acquire) > 0) {
+            if (!_pool.run_one())
+                std::this_thread::yield();
+        }
+    }
+};
+
+namespace parallel_detail {
+
+/// Number of chunks made by the default grain.
+inline constexpr std::size_t default_chunk_count = 256;
+
+/// Returns the grain to use for n values. The default one does not depend on
+/// the pool, so that results do not depend on the number of threads.
+inline std::size_t grain_for(std::size_t n, std::size_t grain) noexcept {
+    if (grain == 0)
+        grain = n / default_chunk_count;
+    return grain > 0 ? grain : 1;
+}
+
+/// Calls fn(chunk) for each chunk of [first, last), splitting the range in
+/// halves and queuing the second one until a single chunk remains.
+template<typename Fn>
+void split_chunks(task_group_t &group, std::size_t first, std::size_t last, Fn const &fn) {
+    while (last - first > 1) {
+        std::size_t const middle = first + (last - first) / 2;
+        group.run([&group, middle, last, &fn] { split_chunks(group, middle, last, fn); });
+        last = middle;
+    }
+    if (first < last)
+        fn(first);
+}
+
+/// Calls fn(chunk, begin, end) on each chunk of grain indices of [0, n), and
+/// returns the number of chunks.
+template<typename Fn>
+std::size_t for_chunks(std::size_t n, std::size_t grain, thread_pool_t &pool, Fn const &fn) {
+    if (n == 0)
+        return 0;
+    grain = grain_for(n, grain);
+    std::size_t const chunk_count = (n + grain - 1) / grain;
+    auto const chunk = [&](std::size_t c) {
+        std::size_t const begin = c * grain;
+        fn(c, begin, std::min(n, begin + grain));
+    };
+    if (chunk_count == 1) {
+        chunk(0);
+        return 1;
+    }
+    task_group_t group(pool);
+    split_chunks(group, 0, chunk_count, chunk);
+    group.wait();
+    return chunk_count;
+}
+
+/// Returns how many values of the sorted run [a, a + na) are among the first
+/// p values of its merge with the sorted run [b, b + nb), values of a coming
+/// first on ties like std::merge.
+template<typename T, typename Compare>
+std::size_t merge_split(T const *a, std::size_t na, T const *b, std::size_t nb, std::size_t p,
+                        Compare const &comp) {
+    std::size_t low = p > nb ? p - nb : 0, high = std::min(p, na);
+    while (low < high) {
+        std::size_t const middle = low + (high - low) / 2;
+        //a[middle] comes after b[p - middle - 1]: fewer values of a are taken
+        if (comp(b[p - middle - 1], a[middle]))
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low;
+}
+
+/// Merges each pair of neighbouring sorted runs of width values of source
+/// into target. The output is cut into chunks of grain values, which divides
+/// width, so that each chunk belongs to a single merge. Each chunk first finds
+/// its share of both runs by binary search, then merges them on its own: all
+/// the searches are done before any value is moved from.
+template<typename T, typename Compare>
+void merge_runs(T *source, T *target, std::size_t n, std::size_t width, Compare const &comp,
+                std::size_t grain, thread_pool_t &pool) {
+    struct run_t {
+        T *a, *b;
+        std::size_t na, nb, base;
+    };
+    auto const runs_of = [&](std::size_t begin) {
+        std::size_t const base = begin - begin % (2 * width);
+        std::size_t const na = std::min(width, n - base);
+        return run_t{source + base, source + base + na, na, std::min(width, n - base - na), base};
+    };
+    //number of values of the first run before each chunk
+    vector_t<std::size_t> splits((n + grain - 1) / grain, default_init);
+    for_chunks(n, grain, pool, [&](std::size_t c, std::size_t begin, std::size_t) {
+        run_t const r = runs_of(begin);
+        splits[c] = merge_split(r.a, r.na, r.b, r.nb, begin - r.base, comp);
+    });
+    for_chunks(n, grain, pool, [&](std::size_t c, std::size_t begin, std::size_t end) {
+        run_t const r = runs_of(begin);
+        //the next chunk starts the next merge, if any
+        std::size_t const a_begin = splits[c];
+        std::size_t const a_end = end - r.base == r.na + r.nb ? r.na : splits[c + 1];
+        std::merge(std::make_move_iterator(r.a + a_begin), std::make_move_iterator(r.a + a_end),
+                   std::make_move_iterator(r.b + (begin - r.base - a_begin)),
+                   std::make_move_iterator(r.b + (end - r.base - a_end)), target + begin, comp);
+    });
+}
+
+} // namespace parallel_detail
+
+/// Calls fn(begin, end) on chunks of grain indices covering [0, n).
+template<typename Fn>
+void parallel_for(std::size_t n, Fn &&fn, std::size_t grain = 0,
+                  thread_pool_t &pool = thread_pool_t::global()) {
+    parallel_detail::for_chunks(n, grain, pool, [&](std::size_t, std::size_t begin, std::size_t end) {
+        fn(begin, end);
+    });
+}
+
+/// Calls fn(value) on every value of range.
+template<std::ranges::contiguous_range Range, typename Fn>
+void parallel_for(Range &&range, Fn &&fn, std::size_t grain = 0,
+                  thread_pool_t &pool = thread_pool_t::global()) {
+    auto *data = std::ranges::data(range);
+    parallel_for(std::size_t(std::ranges::size(range)), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            fn(data[i]);
+        }
+    }, grain, pool);
+}
+
+/// Stores fn(in[i]) in out[i], which must already hold in.size() values.
+template<std::ranges::contiguous_range In, std::ranges::contiguous_range Out, typename Fn>
+void parallel_transform(In const &in, Out &out, Fn &&fn, std::size_t grain = 0,
+                        thread_pool_t &pool = thread_pool_t::global()) {
+    auto const *source = std::ranges::data(in);
+    auto *target = std::ranges::data(out);
+    parallel_for(std::size_t(std::ranges::size(in)), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            target[i] = fn(source[i]);
+        }
+    }, grain, pool);
+}
+
+/// Folds the values of range with op, which must be associative, starting
+/// from init. Each chunk is folded from a copy of init, so init must be an
+/// identity of op.
+template<std::ranges::contiguous_range Range, typename T, typename Op = std::plus<>>
+T parallel_reduce(Range const &range, T init, Op op = Op(), std::size_t grain = 0,
+                  thread_pool_t &pool = thread_pool_t::global()) {
+    auto const *data = std::ranges::data(range);
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    grain = parallel_detail::grain_for(n, grain);
+    vector_t<T> partials;
+    for (std::size_t c = 0; c < (n + grain - 1) / grain; c++) {
+        partials.emplace_back(init);
+    }
+    parallel_detail::for_chunks(n, grain, pool, [&](std::size_t c, std::size_t begin, std::size_t end) {
+        T partial = init;
+        for (std::size_t i = begin; i < end; i++) {
+            partial = op(std::move(partial), data[i]);
+        }
+        partials[c] = std::move(partial);
+    });
+    for (auto &partial : partials) {
+        init = op(std::move(init), std::move(partial));
+    }
+    return init;
+}
+
+/// Stores the inclusive prefix sums of in, computed with op, in out, which
+/// must already hold in.size() values. out may be in itself.
+/// Chunks are summed up in parallel, then their offsets are computed
+/// sequentially, and finally each chunk is scanned from its offset.
+template<std::ranges::contiguous_range In, std::ranges::contiguous_range Out,
+         typename Op = std::plus<>>
+void parallel_scan(In const &in, Out &out, Op op = Op(), std::size_t grain = 0,
+                   thread_pool_t &pool = thread_pool_t::global()) {
+    using T = std::ranges::range_value_t<Out>;
+    auto const *source = std::ranges::data(in);
+    auto *target = std::ranges::data(out);
+    std::size_t const n = std::size_t(std::ranges::size(in));
+    if (n == 0)
+        return;
+    grain = parallel_detail::grain_for(n, grain);
+    std::size_t const chunk_count = (n + grain - 1) / grain;
+    //sum of each chunk but the last one
+    vector_t<T> offsets;
+    offsets.reserve(chunk_count);
+    for (std::size_t c = 0; c < chunk_count; c++) {
+        offsets.emplace_back(source[c * grain]);
+    }
+    parallel_detail::for_chunks((chunk_count - 1) * grain, grain, pool,
+                                [&](std::size_t c, std::size_t begin, std::size_t end) {
+        T sum = source[begin];
+        for (std::size_t i = begin + 1; i < end; i++) {
+            sum = op(std::move(sum), source[i]);
+        }
+        offsets[c] = std::move(sum);
+    });
+
+    //offsets[c] becomes the sum of the chunks before c, offsets[0] is unused
+    for (std::size_t c = chunk_count - 1; c > 0; c--) {
+        offsets[c] = offsets[c - 1];
+    }
+    for (std::size_t c = 2; c < chunk_count; c++) {
+        offsets[c] = op(offsets[c - 1], offsets[c]);
+    }
+
+    parallel_detail::for_chunks(n, grain, pool, [&](std::size_t c, std::size_t begin, std::size_t end) {
+        T sum = c > 0 ? op(offsets[c], source[begin]) : T(source[begin]);
+        target[begin] = sum;
+        for (std::size_t i = begin + 1; i < end; i++) {
+            sum = op(std::move(sum), source[i]);
+            target[i] = sum;
+        }
+    });
+}
+
+/// Sorts the values of range with comp, by merge sort: chunks of grain
+/// values are sorted in parallel with std::sort, then pairs of sorted runs
+/// are merged back and forth with a buffer of range.size() values, every
+/// merge being split across the threads too. The values must be default
+/// constructible and move assignable. The sort is not stable.
+template<std::ranges::contiguous_range Range, typename Compare = std::less<>>
+void parallel_sort(Range &&range, Compare comp = Compare(), std::size_t grain = 0,
+                   thread_pool_t &pool = thread_pool_t::global()) {
+    using T = std::ranges::range_value_t<Range>;
+    T *const first = std::ranges::data(range);
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    if (n < 2)
+        return;
+    grain = parallel_detail::grain_for(n, grain);
+    parallel_detail::for_chunks(n, grain, pool, [&](std::size_t, std::size_t begin, std::size_t end) {
+        std::sort(first + begin, first + end, comp);
+    });
+    if (grain >= n)
+        return;
+    vector_t<T> buffer(n, default_init);
+    T *source = first, *target = buffer.data();
+    for (std::size_t width = grain; width < n; width *= 2) {
+        parallel_detail::merge_runs(source, target, n, width, comp, grain, pool);
+        std::swap(source, target);
+    }
+    if (source != first) {
+        parallel_for(n, [&](std::size_t begin, std::size_t end) {
+            std::move(source + begin, source + end, first + begin);
+        }, grain, pool);
+    }
+}
+
+/// Returns a tag making vector_t constructors and resize() value-initialize
+/// at least min_bytes of new values on the threads of pool, in chunks of
+/// grain values: vector_t<int> vec(n, parallel_init());
+inline auto parallel_init(thread_pool_t &pool = thread_pool_t::global(), std::size_t grain = 0,
+                          std::size_t min_bytes = std::size_t(1) << 20) {
+    auto split = [&pool, grain](std::size_t n, auto const &fn) {
+        parallel_for(n, fn, grain, pool);
+    };
+    return parallel_init_t<decltype(split)>{split, min_bytes};
+}
@@ -0,0 +1,467 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// segmented_vector_t ----------------------------------------------------------
+
+// segmented_vector_t<T> is a vector whose values never move: instead of
+// relocating its buffer, it grows by allocating a new segment, and keeps the
+// previous ones in place. Pointers and references to values stay valid until
+// the values are destroyed, which makes it suitable for registries handing
+// out pointers to their entries.
+
+// Segments grow geometrically, like in TBB's concurrent_vector: segment 0
+// holds FirstSegment values, and segment k > 0 holds FirstSegment << (k - 1)
+// values, so that segment k starts at index FirstSegment << (k - 1) and the
+// capacity doubles with every segment. The segment holding index i is the
+// bit width of i / FirstSegment, which makes random access O(1) with a shift
+// and a bit scan. The segment table is a fixed array stored in the vector,
+// large enough for any size: it is never reallocated either.
+
+// It follows the invariants and lifetime rules of vector_t (see vector.hpp),
+// except that:
+// - _segment_count segments are allocated, and the other entries of the
+// segment table are nullptr,
+// - the capacity is the total size of the allocated segments,
+// - values are only contiguous within a segment. Iterators are random access,
+// but loops meant to be vectorized should go through segment(k), which
+// returns the live values of segment k as a std::span.
+
+/// Index math shared by the segmented containers: segment 0 holds
+/// FirstSegment values, and segment k > 0 holds FirstSegment << (k - 1)
+/// values.
+template<std::size_t FirstSegment>
+struct segment_layout_t {
+    static_assert(std::has_single_bit(FirstSegment),
+                  "segment_layout_t: the first segment size must be a power of two");
+
+    /// Number of segments needed to cover every index that fits in a
+    /// std::size_t.
+    static constexpr std::size_t max_segments =
+        std::size_t(std::numeric_limits<std::size_t>::digits - std::countr_zero(FirstSegment));
+
+    /// Number of values held by segment k.
+    static constexpr std::size_t segment_size(std::size_t k) noexcept {
+        return k == 0 ? FirstSegment : FirstSegment << (k - 1);
+    }
+
+    /// Index of the first value of segment k.
+    static constexpr std::size_t segment_start(std::size_t k) noexcept {
+        return k == 0 ? 0 : FirstSegment << (k - 1);
+    }
+
+    /// Segment holding the value of index i.
+    static constexpr std::size_t segment_of(std::size_t i) noexcept {
+        return std::size_t(std::bit_width(i >> std::countr_zero(FirstSegment)));
+    }
+
+    /// Total size of the first count segments.
+    static constexpr std::size_t capacity_of(std::size_t count) noexcept {
+        return count == 0 ? 0 : FirstSegment << (count - 1);
+    }
+};
+
+template<typename T, typename Allocator = std::allocator<T>, std::size_t FirstSegment = 16>
+struct segmented_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    /// Size of the first segment.
+    static constexpr std::size_t first_segment = FirstSegment;
+
+    /// Number of entries of the segment table.
+    static constexpr std::size_t max_segments = segment_layout_t<FirstSegment>::max_segments;
+
+private:
+    using layout = segment_layout_t<FirstSegment>;
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "segmented_vector_t: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T *>,
+                  "segmented_vector_t: fancy pointers are not supported");
+
+    /// Segment table. The first _segment_count entries point to allocated
+    /// segments, the other ones are nullptr. The extra entry is never
+    /// allocated, and is only looked up by end iterators of a full table.
+    T *_segments[max_segments + 1] = {};
+
+    /// Size of the vector.
+    /// Holds the number of alive values.
+    std::size_t _size;
+
+    /// Number of allocated segments.
+    std::size_t _segment_count;
+
+    /// Memory allocator.
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Address of the value of index i, which must be in an allocated segment.
+    T *slot(std::size_t i) const noexcept {
+        std::size_t const k = layout::segment_of(i);
+        return _segments[k] + (i - layout::segment_start(k));
+    }
+
+    /// Calls fn(first, last) on each contiguous range of slots of index
+    /// begin to end - 1, which must be in allocated segments.
+    template<typename Fn>
+    void for_each_range(std::size_t begin, std::size_t end, Fn &&fn) const {
+        while (begin < end) {
+            std::size_t const k = layout::segment_of(begin);
+            std::size_t const last =
+                std::min(end, layout::segment_start(k) + layout::segment_size(k));
+            T *first = _segments[k] + (begin - layout::segment_start(k));
+            fn(first, first + (last - begin));
+            begin = last;
+        }
+    }
+
+    /// Value-initializes[1] the values of rank _size to new_size - 1, with a
+    /// memset per segment for zero initializable values (see vector.hpp). The
+    /// segments must be allocated.
+    void construct_tail(std::size_t new_size) {
+        if constexpr (is_zero_initializable_v<T>) {
+            if (new_size > _size) {
+                for_each_range(_size, new_size, [](T *first, T *last) {
+                    std::memset(static_cast<void *>(first), 0, std::size_t(last - first) * sizeof(T));
+                });
+                _size = new_size;
+            }
+        } else {
+            for (; _size < new_size; _size++) {
+                alloc_traits::construct(_allocator, slot(_size));
+            }
+        }
+    }
+
+    /// Destroys[1] the values of rank new_size to _size - 1.
+    void destroy_tail(std::size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; _size > new_size; _size--) {
+                alloc_traits::destroy(_allocator, slot(_size - 1));
+            }
+        }
+        if (new_size < _size)
+            _size = new_size;
+    }
+
+    /// Deallocates the segments past the first count ones, which must not
+    /// hold live values.
+    void deallocate_segments(std::size_t count) noexcept {
+        for (; _segment_count > count; _segment_count--) {
+            std::size_t const k = _segment_count - 1;
+            alloc_traits::deallocate(_allocator, _segments[k], layout::segment_size(k));
+            _segments[k] = nullptr;
+        }
+    }
+
+    /// Destroys all the values and deallocates every segment.
+    void release() noexcept {
+        destroy_tail(0);
+        deallocate_segments(0);
+    }
+
+    /// Takes the segments of other, leaving it empty.
+    /// The current segments must have been released beforehand.
+    void steal(segmented_vector_t &other) noexcept {
+        for (std::size_t k = 0; k < other._segment_count; k++) {
+            _segments[k] = std::exchange(other._segments[k], nullptr);
+        }
+        _size = std::exchange(other._size, 0);
+        _segment_count = std::exchange(other._segment_count, 0);
+    }
+
+    /// Copies or moves the values of other one by one.
+    /// There must be no live values.
+    template<typename Other>
+    void construct_values(Other &&other) {
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            if constexpr (std::is_lvalue_reference_v<Other>)
+                alloc_traits::construct(_allocator, slot(_size), other[_size]);
+            else
+                alloc_traits::construct(_allocator, slot(_size), std::move(other[_size]));
+        }
+    }
+
+public:
+    /// Random access iterator over the values. Incrementing only checks
+    /// whether the end of the current segment was reached, the other
+    /// operations locate the segment from the index.
+    template<typename V>
+    struct iterator_t {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V *;
+        using reference = V &;
+
+    private:
+        friend segmented_vector_t;
+
+        T *const *_table = nullptr;
+        std::size_t _index = 0;
+        V *_ptr = nullptr;
+        V *_segment_end = nullptr;
+
+        iterator_t(T *const *table, std::size_t index) noexcept : _table(table), _index(index) {
+            seek();
+        }
+
+        /// Points _ptr to the slot of _index. Only the end iterator of a full
+        /// vector can be in an unallocated segment, at offset 0, in which case
+        /// _ptr and _segment_end are nullptr.
+        void seek() noexcept {
+            std::size_t const k = layout::segment_of(_index);
+            V *const segment = _table[k];
+            _ptr = segment + (_index - layout::segment_start(k));
+            _segment_end = segment ? segment + layout::segment_size(k) : segment;
+        }
+
+    public:
+        iterator_t() noexcept = default;
+
+        /// Conversion from mutable to constant iterators.
+        operator iterator_t<V const>() const noexcept {
+            iterator_t<V const> it;
+            it._table = _table;
+            it._index = _index;
+            it._ptr = _ptr;
+            it._segment_end = _segment_end;
+            return it;
+        }
+
+        V &operator*() const noexcept { return *_ptr; }
+        V *operator->() const noexcept { return _ptr; }
+        V &operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        iterator_t &operator++() noexcept {
+            _index++;
+            if (++_ptr == _segment_end)
+                seek();
+            return *this;
+        }
+
+        iterator_t operator++(int) noexcept {
+            iterator_t it = *this;
+            ++*this;
+            return it;
+        }
+
+        iterator_t &operator--() noexcept { return *this -= 1; }
+
+        iterator_t operator--(int) noexcept {
+            iterator_t it = *this;
+            --*this;
+            return it;
+        }
+
+        iterator_t &operator+=(difference_type n) noexcept {
+            _index += std::size_t(n);
+            seek();
+            return *this;
+        }
+
+        iterator_t &operator-=(difference_type n) noexcept { return *this += -n; }
+
+        friend iterator_t operator+(iterator_t it, difference_type n) noexcept { return it += n; }
+        friend iterator_t operator+(difference_type n, iterator_t it) noexcept { return it += n; }
+        friend iterator_t operator-(iterator_t it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(iterator_t const &a, iterator_t const &b) noexcept {
+            return difference_type(a._index - b._index);
+        }
+
+        friend bool operator==(iterator_t const &a, iterator_t const &b) noexcept {
+            return a._index == b._index;
+        }
+
+        friend auto operator<=>(iterator_t const &a, iterator_t const &b) noexcept {
+            return a._index <=> b._index;
+        }
+
+        template<typename>
+        friend struct iterator_t;
+    };
+
+    using iterator = iterator_t<T>;
+    using const_iterator = iterator_t<T const>;
+
+    /// Initializes an empty vector with no segment.
+    segmented_vector_t() noexcept(noexcept(Allocator()))
+        : _size(0), _segment_count(0), _allocator() {}
+
+    explicit segmented_vector_t(Allocator const &alloc) noexcept
+        : _size(0), _segment_count(0), _allocator(alloc) {}
+
+    /// Initializes a vector of s value-initialized[1] values.
+    explicit segmented_vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : segmented_vector_t(alloc) {
+        resize(s);
+    }
+
+    //copy constructor
+    segmented_vector_t(segmented_vector_t const &other)
+        : segmented_vector_t(alloc_traits::select_on_container_copy_construction(
+              other._allocator)) {
+        construct_values(other);
+    }
+
+    //move constructor: the segments are handed over, so pointers to the
+    //values stay valid
+    segmented_vector_t(segmented_vector_t &&other) noexcept
+        : segmented_vector_t(std::move(other._allocator)) {
+        steal(other);
+    }
+
+    //copy assignment operator: the segments are reused
+    segmented_vector_t &operator=(segmented_vector_t const &other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            //the segments belong to the old allocator
+            if (!alloc_traits::is_always_equal::value && _allocator != other._allocator)
+                deallocate_segments(0);
+            _allocator = other._allocator;
+        }
+        construct_values(other);
+        return *this;
+    }
+
+    //Move assignment operator
+    segmented_vector_t &operator=(segmented_vector_t &&other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other)
+            return *this;
+        release();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            _allocator = std::move(other._allocator);
+        } else if (!alloc_traits::is_always_equal::value &&
+                   _allocator != other._allocator) {
+            //the segments of other cannot be handed over to our allocator
+            construct_values(std::move(other));
+            return *this;
+        }
+        steal(other);
+        return *this;
+    }
+
+    /// Exchanges the contents of two vectors. Allocators are only swapped if
+    /// they propagate on swap, otherwise they must compare equal.
+    void swap(segmented_vector_t &other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(_allocator, other._allocator);
+        }
+        swap(_segments, other._segments);
+        swap(_size, other._size);
+        swap(_segment_count, other._segment_count);
+    }
+
+    friend void swap(segmented_vector_t &a, segmented_vector_t &b) noexcept { a.swap(b); }
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Returns an iterator to the beginning of the vector.
+    iterator begin() noexcept { return iterator(_segments, 0); }
+
+    /// Returns an iterator to the end of the vector.
+    iterator end() noexcept { return iterator(_segments, _size); }
+
+    /// Returns a constant iterator to the beginning of the vector.
+    const_iterator begin() const noexcept { return const_iterator(_segments, 0); }
+
+    /// Returns a constant iterator to the end of the vector.
+    const_iterator end() const noexcept { return const_iterator(_segments, _size); }
+
+    /// Returns the size of the vector.
+    std::size_t size() const { return _size; }
+
+    /// Returns the total size of the allocated segments.
+    std::size_t capacity() const { return layout::capacity_of(_segment_count); }
+
+    /// Returns the number of segments holding live values.
+    std::size_t segment_count() const { return _size == 0 ? 0 : layout::segment_of(_size - 1) + 1; }
+
+    /// Returns the live values of segment k, which are contiguous, or an
+    /// empty span if k >= segment_count().
+    std::span<T> segment(std::size_t k) {
+        if (k >= segment_count())
+            return {};
+        std::size_t const start = layout::segment_start(k);
+        return {_segments[k], std::min(_size - start, layout::segment_size(k))};
+    }
+
+    /// Returns the live values of segment k, which are contiguous, or an
+    /// empty span if k >= segment_count().
+    std::span<T const> segment(std::size_t k) const {
+        if (k >= segment_count())
+            return {};
+        std::size_t const start = layout::segment_start(k);
+        return {_segments[k], std::min(_size - start, layout::segment_size(k))};
+    }
+
+    /// Non-const element access for getting and modifying elements.
+    T &operator[](std::size_t i) { return *slot(i); }
+
+    /// Read-only element access.
+    T const &operator[](std::size_t i) const { return *slot(i); }
+
+    /// Constructs a new element at the end of the vector, allocating a new
+    /// segment if needed. Values never move, and the returned reference stays
+    /// valid until the value is destroyed.
+    template<typename... Args>
+    T &emplace_back(Args &&...args) {
+        if (_size == capacity())
+            reserve(_size + 1);
+        T *value = slot(_size);
+        alloc_traits::construct(_allocator, value, std::forward<Args>(args)...);
+        _size++;
+        return *value;
+    }
+
+    /// Allocates segments until the capacity reaches new_capacity. Values
+    /// never move. Throws std::bad_alloc if the segment table is full.
+    void reserve(std::size_t new_capacity) {
+        while (capacity() < new_capacity) {
+            if (_segment_count == max_segments)
+                throw std::bad_alloc();
+            _segments[_segment_count] =
+                alloc_traits::allocate(_allocator, layout::segment_size(_segment_count));
+            _segment_count++;
+        }
+    }
+
+    /// Sets the size of the vector, destroying or value-initializing[1] values
+    /// as necessary, and allocating segments as needed.
+    void resize(std::size_t new_size) {
+        reserve(new_size);
+        construct_tail(new_size);
+        destroy_tail(new_size);
+    }
+
+    /// Deallocates the segments that hold no live value.
+    void shrink_to_fit() noexcept { deallocate_segments(segment_count()); }
+
+    /// Destroys the values and deallocates the segments.
+    ~segmented_vector_t() { release(); }
+};
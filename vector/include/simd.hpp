@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "cpu_dispatch.hpp"
+
+#if VECTOR_T_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// SIMD search kernels ---------------------------------------------------------
+
+// This header provides vectorized versions of the searches that filter-heavy
+// code runs over columns of numbers, for any contiguous range of integers or
+// floating point values such as vector_t<std::int32_t>:
+// - simd_find(range, value) returns a pointer to the first value equal to
+// value, or to the end of range,
+// - simd_count(range, value) counts the values equal to value,
+// - simd_contains(range, value) tells whether range holds value,
+// - simd_min_element(range) and simd_max_element(range) return a pointer to
+// the first smallest or largest value, or to the end of an empty range,
+// - simd_minmax(range) returns the smallest and largest values of a range
+// that must not be empty.
+
+// Each kernel is written once with GCC vector extensions, and compiled for
+// 16, 32 and 64 bytes wide vectors with the target attribute of SSE2, AVX2 and
+// AVX-512 respectively, so that the rest of the program keeps the baseline
+// instruction set. Comparison results are turned into bitmasks with the
+// movemask instructions of each set. The kernels are bound to each level by
+// a simd_dispatch_t (see cpu_dispatch.hpp), and the functions call the ones
+// of simd_level() unless they are given another level. Other compilers and
+// architectures only get the scalar kernels.
+
+// For floating point values, min and max results are unspecified when the
+// range holds NaNs, since the vector instructions do not order them like
+// std::min_element does.
+
+/// Values the kernels work on: integers and floating point values of at most
+/// 8 bytes, except bool.
+template<typename T>
+concept simd_value = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+namespace simd_detail {
+
+/// Portable kernels, also used for the last values of the vector ones.
+struct scalar_t {
+    template<typename T>
+    static std::size_t find(T const *data, std::size_t n, T value) noexcept {
+        return std::size_t(std::find(data, data + n, value) - data);
+    }
+
+    template<typename T>
+    static std::size_t count(T const *data, std::size_t n, T value) noexcept {
+        return std::size_t(std::count(data, data + n, value));
+    }
+
+    template<typename T>
+    static T min(T const *data, std::size_t n) noexcept {
+        return *std::min_element(data, data + n);
+    }
+
+    template<typename T>
+    static T max(T const *data, std::size_t n) noexcept {
+        return *std::max_element(data, data + n);
+    }
+
+    template<typename T>
+    static std::pair<T, T> minmax(T const *data, std::size_t n) noexcept {
+        auto const [min, max] = std::minmax_element(data, data + n);
+        return {*min, *max};
+    }
+};
+
+#if VECTOR_T_SIMD_X86
+
+/// Vector of Bytes bytes.
+template<std::size_t Bytes>
+using bytes_t [[gnu::vector_size(Bytes)]] = std::int8_t;
+
+//the movemask functions are not always inline: they are inlined once the
+//kernels are, in functions compiled for their instruction set
+
+/// Returns the most significant bit of each byte of mask.
+[[gnu::target("sse2")]] inline std::uint64_t movemask(bytes_t<16> const &mask) noexcept {
+    __m128i m;
+    std::memcpy(&m, &mask, sizeof(m));
+    return std::uint32_t(_mm_movemask_epi8(m));
+}
+
+[[gnu::target("avx2")]] inline std::uint64_t movemask(bytes_t<32> const &mask) noexcept {
+    __m256i m;
+    std::memcpy(&m, &mask, sizeof(m));
+    return std::uint32_t(_mm256_movemask_epi8(m));
+}
+
+[[gnu::target("avx512f,avx512bw")]] inline std::uint64_t movemask(bytes_t<64> const &mask) noexcept {
+    __m512i m;
+    std::memcpy(&m, &mask, sizeof(m));
+    return _mm512_movepi8_mask(m);
+}
+
+/// Kernels on vectors of Bytes bytes. They are inlined in the functions of
+/// sse2_t, avx2_t and avx512_t, which are compiled for the matching
+/// instruction set. Vectors are never passed by value, since their calling
+/// convention depends on the instruction set.
+template<typename T, std::size_t Bytes>
+struct kernels_t {
+    using vec_t [[gnu::vector_size(Bytes)]] = T;
+
+    /// Result of comparisons: signed lanes of the width of T, set to -1 where
+    /// true.
+    using lane_t = std::conditional_t<
+        sizeof(T) == 1, std::int8_t,
+        std::conditional_t<sizeof(T) == 2, std::int16_t,
+                           std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>>>;
+    using mask_t [[gnu::vector_size(Bytes)]] = lane_t;
+
+    static constexpr std::size_t lanes = Bytes / sizeof(T);
+
+    /// Returns a bitmask with sizeof(T) bits set for each lane set in mask.
+    [[gnu::always_inline]] static inline std::uint64_t bits(mask_t const &mask) noexcept {
+        bytes_t<Bytes> bytes;
+        std::memcpy(&bytes, &mask, Bytes);
+        return movemask(bytes);
+    }
+
+    [[gnu::always_inline]] static inline void load(vec_t &v, T const *data) noexcept {
+        std::memcpy(&v, data, Bytes);
+    }
+
+    [[gnu::always_inline]] static inline void broadcast(vec_t &v, T value) noexcept {
+        for (std::size_t l = 0; l < lanes; l++) {
+            v[l] = value;
+        }
+    }
+
+    [[gnu::always_inline]] static inline std::size_t find(T const *data, std::size_t n,
+                                                          T value) noexcept {
+        vec_t needle, a, b, c, d;
+        broadcast(needle, value);
+        std::size_t i = 0;
+        //four vectors per iteration, whose masks are tested at once
+        for (; i + 4 * lanes <= n; i += 4 * lanes) {
+            load(a, data + i);
+            load(b, data + i + lanes);
+            load(c, data + i + 2 * lanes);
+            load(d, data + i + 3 * lanes);
+            if (bits(a == needle) | bits(b == needle) | bits(c == needle) | bits(d == needle))
+                break;
+        }
+        for (; i + lanes <= n; i += lanes) {
+            load(a, data + i);
+            if (std::uint64_t const set = bits(a == needle))
+                return i + std::size_t(std::countr_zero(set)) / sizeof(T);
+        }
+        return i + scalar_t::find(data + i, n - i, value);
+    }
+
+    [[gnu::always_inline]] static inline std::size_t count(T const *data, std::size_t n,
+                                                           T value) noexcept {
+        //matches are counted down in lanes of the width of T, which are
+        //flushed before they can overflow
+        constexpr std::size_t flush_every =
+            std::min<std::size_t>(std::numeric_limits<lane_t>::max(), std::size_t(1) << 20);
+        vec_t needle, v;
+        broadcast(needle, value);
+        std::size_t total = 0;
+        std::size_t i = 0;
+        while (i + lanes <= n) {
+            std::size_t const blocks = std::min(flush_every, (n - i) / lanes);
+            mask_t counts{};
+            for (std::size_t b = 0; b < blocks; b++, i += lanes) {
+                load(v, data + i);
+                counts += v == needle;
+            }
+            for (std::size_t l = 0; l < lanes; l++) {
+                total += std::size_t(-std::int64_t(counts[l]));
+            }
+        }
+        return total + scalar_t::count(data + i, n - i, value);
+    }
+
+    /// Smallest and largest values of a non-empty range.
+    [[gnu::always_inline]] static inline void minmax(T const *data, std::size_t n, T *min,
+                                                     T *max) noexcept {
+        std::size_t i = 0;
+        if (n >= lanes) {
+            vec_t lo, hi, v;
+            load(lo, data);
+            hi = lo;
+            for (i = lanes; i + lanes <= n; i += lanes) {
+                load(v, data + i);
+                if (min)
+                    lo = v < lo ? v : lo;
+                if (max)
+                    hi = hi < v ? v : hi;
+            }
+            if (min) {
+                *min = lo[0];
+                for (std::size_t l = 1; l < lanes; l++) {
+                    *min = lo[l] < *min ? lo[l] : *min;
+                }
+            }
+            if (max) {
+                *max = hi[0];
+                for (std::size_t l = 1; l < lanes; l++) {
+                    *max = *max < hi[l] ? hi[l] : *max;
+                }
+            }
+        } else {
+            if (min)
+                *min = data[0];
+            if (max)
+                *max = data[0];
+        }
+        for (; i < n; i++) {
+            if (min && data[i] < *min)
+                *min = data[i];
+            if (max && *max < data[i])
+                *max = data[i];
+        }
+    }
+};
+
+struct sse2_t {
+    template<typename T>
+    [[gnu::target("sse2")]] static std::size_t find(T const *data, std::size_t n,
+                                                    T value) noexcept {
+        return kernels_t<T, 16>::find(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("sse2")]] static std::size_t count(T const *data, std::size_t n,
+                                                     T value) noexcept {
+        return kernels_t<T, 16>::count(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("sse2")]] static T min(T const *data, std::size_t n) noexcept {
+        T min;
+        kernels_t<T, 16>::minmax(data, n, &min, nullptr);
+        return min;
+    }
+
+    template<typename T>
+    [[gnu::target("sse2")]] static T max(T const *data, std::size_t n) noexcept {
+        T max;
+        kernels_t<T, 16>::minmax(data, n, nullptr, &max);
+        return max;
+    }
+
+    template<typename T>
+    [[gnu::target("sse2")]] static std::pair<T, T> minmax(T const *data, std::size_t n) noexcept {
+        T min, max;
+        kernels_t<T, 16>::minmax(data, n, &min, &max);
+        return {min, max};
+    }
+};
+
+struct avx2_t {
+    template<typename T>
+    [[gnu::target("avx2")]] static std::size_t find(T const *data, std::size_t n,
+                                                    T value) noexcept {
+        return kernels_t<T, 32>::find(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("avx2")]] static std::size_t count(T const *data, std::size_t n,
+                                                     T value) noexcept {
+        return kernels_t<T, 32>::count(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("avx2")]] static T min(T const *data, std::size_t n) noexcept {
+        T min;
+        kernels_t<T, 32>::minmax(data, n, &min, nullptr);
+        return min;
+    }
+
+    template<typename T>
+    [[gnu::target("avx2")]] static T max(T const *data, std::size_t n) noexcept {
+        T max;
+        kernels_t<T, 32>::minmax(data, n, nullptr, &max);
+        return max;
+    }
+
+    template<typename T>
+    [[gnu::target("avx2")]] static std::pair<T, T> minmax(T const *data, std::size_t n) noexcept {
+        T min, max;
+        kernels_t<T, 32>::minmax(data, n, &min, &max);
+        return {min, max};
+    }
+};
+
+struct avx512_t {
+    template<typename T>
+    [[gnu::target("avx512f,avx512bw")]] static std::size_t find(T const *data, std::size_t n,
+                                                                T value) noexcept {
+        return kernels_t<T, 64>::find(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("avx512f,avx512bw")]] static std::size_t count(T const *data, std::size_t n,
+                                                                 T value) noexcept {
+        return kernels_t<T, 64>::count(data, n, value);
+    }
+
+    template<typename T>
+    [[gnu::target("avx512f,avx512bw")]] static T min(T const *data, std::size_t n) noexcept {
+        T min;
+        kernels_t<T, 64>::minmax(data, n, &min, nullptr);
+        return min;
+    }
+
+    template<typename T>
+    [[gnu::target("avx512f,avx512bw")]] static T max(T const *data, std::size_t n) noexcept {
+        T max;
+        kernels_t<T, 64>::minmax(data, n, nullptr, &max);
+        return max;
+    }
+
+    template<typename T>
+    [[gnu::target("avx512f,avx512bw")]] static std::pair<T, T> minmax(T const *data,
+                                                                      std::size_t n) noexcept {
+        T min, max;
+        kernels_t<T, 64>::minmax(data, n, &min, &max);
+        return {min, max};
+    }
+};
+
+#endif
+
+/// Returns the dispatcher of the kernels that select picks among the ones
+/// of each level, which is initialized on the first call.
+template<typename Signature, typename Select>
+simd_dispatch_t<Signature> const &dispatch(Select select) noexcept {
+#if VECTOR_T_SIMD_X86
+    static simd_dispatch_t<Signature> const kernels(select(scalar_t()), select(sse2_t()),
+                                                    select(avx2_t()), select(avx512_t()));
+#else
+    static simd_dispatch_t<Signature> const kernels(select(scalar_t()));
+#endif
+    return kernels;
+}
+
+} // namespace simd_detail
+
+/// Returns a pointer to the first value of range equal to value, or to the
+/// end of range.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+auto *simd_find(Range &&range, std::type_identity_t<T> value,
+                simd_level_t level = simd_level()) noexcept {
+    auto *data = std::ranges::data(range);
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    auto const &find = simd_detail::dispatch<std::size_t(T const *, std::size_t, T)>(
+        [](auto isa) { return &decltype(isa)::template find<T>; });
+    return data + find.at(level)(data, n, value);
+}
+
+/// Returns the number of values of range equal to value.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+std::size_t simd_count(Range const &range, std::type_identity_t<T> value,
+                       simd_level_t level = simd_level()) noexcept {
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    auto const &count = simd_detail::dispatch<std::size_t(T const *, std::size_t, T)>(
+        [](auto isa) { return &decltype(isa)::template count<T>; });
+    return count.at(level)(std::ranges::data(range), n, value);
+}
+
+/// Tells whether range holds a value equal to value.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+bool simd_contains(Range const &range, std::type_identity_t<T> value,
+                   simd_level_t level = simd_level()) noexcept {
+    return simd_find(range, value, level) != std::ranges::data(range) + std::ranges::size(range);
+}
+
+/// Returns a pointer to the first smallest value of range, or to the end of
+/// range if it is empty.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+auto *simd_min_element(Range &&range, simd_level_t level = simd_level()) noexcept {
+    auto *data = std::ranges::data(range);
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    if (n == 0)
+        return data;
+    auto const &min = simd_detail::dispatch<T(T const *, std::size_t)>(
+        [](auto isa) { return &decltype(isa)::template min<T>; });
+    auto *found = simd_find(range, min.at(level)(data, n), level);
+    //the value is not found if it is a NaN
+    return found != data + n ? found : std::min_element(data, data + n);
+}
+
+/// Returns a pointer to the first largest value of range, or to the end of
+/// range if it is empty.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+auto *simd_max_element(Range &&range, simd_level_t level = simd_level()) noexcept {
+    auto *data = std::ranges::data(range);
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    if (n == 0)
+        return data;
+    auto const &max = simd_detail::dispatch<T(T const *, std::size_t)>(
+        [](auto isa) { return &decltype(isa)::template max<T>; });
+    auto *found = simd_find(range, max.at(level)(data, n), level);
+    //the value is not found if it is a NaN
+    return found != data + n ? found : std::max_element(data, data + n);
+}
+
+/// Returns the smallest and largest values of range, which must not be
+/// empty.
+template<std::ranges::contiguous_range Range, simd_value T = std::ranges::range_value_t<Range>>
+std::pair<T, T> simd_minmax(Range const &range, simd_level_t level = simd_level()) noexcept {
+    std::size_t const n = std::size_t(std::ranges::size(range));
+    auto const &minmax = simd_detail::dispatch<std::pair<T, T>(T const *, std::size_t)>(
+        [](auto isa) { return &decltype(isa)::template minmax<T>; });
+    return minmax.at(level)(std::ranges::data(range), n);
+}
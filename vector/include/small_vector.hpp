@@ -0,0 +1,290 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// small_vector_t --------------------------------------------------------------
+
+// small_vector_t<T, N> is a vector_t that stores up to N values inside the
+// object itself, and only spills to a heap buffer drawn from its allocator
+// once it needs to hold more than that. Vectors that stay small therefore
+// never allocate.
+
+// It follows the same invariants and lifetime rules as vector_t (see
+// vector.hpp), with one addition: _data either points to the inline storage,
+// in which case _capacity is N, or to a heap buffer of _capacity values.
+// Since _data may point into the object itself, moving a small_vector_t in the
+// inline state has to move the values one by one. Once on the heap, a
+// small_vector_t never goes back to its inline storage, except when it is
+// moved from or assigned to.
+
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+struct small_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(N > 0, "small_vector_t: use vector_t for N == 0");
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "small_vector_t: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T *>,
+                  "small_vector_t: fancy pointers are not supported");
+
+    /// Pointer to the memory buffer: either the inline storage or a heap
+    /// buffer. It is never nullptr.
+    T *_data;
+
+    /// Size of the vector.
+    /// Holds the number of alive values.
+    std::size_t _size;
+
+    /// Capacity of the memory buffer, N when using the inline storage.
+    std::size_t _capacity;
+
+    /// Memory allocator, only used for heap buffers.
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Inline storage for N values.
+    alignas(T) std::byte _inline[N * sizeof(T)];
+
+    T *inline_data() noexcept { return reinterpret_cast<T *>(_inline); }
+
+    /// Value-initializes[1] the values of rank _size to new_size - 1.
+    void construct_tail(std::size_t new_size) {
+        if constexpr (is_zero_initializable_v<T>) {
+            if (new_size > _size) {
+                std::memset(static_cast<void *>(_data + _size), 0,
+                            (new_size - _size) * sizeof(T));
+                _size = new_size;
+            }
+        } else {
+            for (; _size < new_size; _size++) {
+                alloc_traits::construct(_allocator, _data + _size);
+            }
+        }
+    }
+
+    /// Destroys[1] the values of rank new_size to _size - 1.
+    void destroy_tail(std::size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; _size > new_size; _size--) {
+                alloc_traits::destroy(_allocator, _data + _size - 1);
+            }
+        }
+        if (new_size < _size)
+            _size = new_size;
+    }
+
+    /// Deallocates the heap buffer, if any, and goes back to the inline
+    /// storage. There must be no live values.
+    void release_heap() noexcept {
+        if (!is_inline()) {
+            alloc_traits::deallocate(_allocator, _data, _capacity);
+            _data = inline_data();
+            _capacity = N;
+        }
+    }
+
+    /// Moves the live values to a heap buffer that can hold new_capacity
+    /// values, following the same rules as vector_t::relocate.
+    void relocate(std::size_t new_capacity) {
+        T *new_buffer = alloc_traits::allocate(_allocator, new_capacity);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (_size)
+                std::memcpy(static_cast<void *>(new_buffer),
+                            static_cast<void const *>(_data), _size * sizeof(T));
+        } else {
+            for (std::size_t i = 0; i < _size; i++) {
+                alloc_traits::construct(_allocator, new_buffer + i, std::move(_data[i]));
+            }
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (std::size_t i = 0; i < _size; i++) {
+                    alloc_traits::destroy(_allocator, _data + i);
+                }
+            }
+        }
+        if (!is_inline())
+            alloc_traits::deallocate(_allocator, _data, _capacity);
+        _data = new_buffer;
+        _capacity = new_capacity;
+    }
+
+    /// Takes the heap buffer of other, which goes back to its inline storage.
+    /// The current values and heap buffer must have been released beforehand.
+    void steal(small_vector_t &other) noexcept {
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = other.inline_data();
+        other._size = 0;
+        other._capacity = N;
+    }
+
+    /// Moves the values of other one by one, then destroys them.
+    /// There must be no live values.
+    void move_values(small_vector_t &other) {
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            alloc_traits::construct(_allocator, _data + _size, std::move(other._data[_size]));
+        }
+        other.destroy_tail(0);
+    }
+
+public:
+    /// Initializes an empty vector using its inline storage.
+    small_vector_t() noexcept(noexcept(Allocator()))
+        : _data(inline_data()), _size(0), _capacity(N), _allocator() {}
+
+    explicit small_vector_t(Allocator const &alloc) noexcept
+        : _data(inline_data()), _size(0), _capacity(N), _allocator(alloc) {}
+
+    /// Initializes a vector of s value-initialized[1] values. Unlike vector_t,
+    /// the capacity is N if s <= N.
+    explicit small_vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : small_vector_t(alloc) {
+        resize(s);
+    }
+
+    //copy constructor
+    small_vector_t(small_vector_t const &other)
+        : small_vector_t(alloc_traits::select_on_container_copy_construction(
+              other._allocator)) {
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            alloc_traits::construct(_allocator, _data + _size, other._data[_size]);
+        }
+    }
+
+    //move constructor: heap buffers are stolen, inline values are moved one
+    //by one. Either way, other is left empty.
+    small_vector_t(small_vector_t &&other) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : small_vector_t(std::move(other._allocator)) {
+        if (other.is_inline())
+            move_values(other);
+        else
+            steal(other);
+    }
+
+    //copy assignment operator
+    small_vector_t &operator=(small_vector_t const &other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            //the heap buffer belongs to the old allocator
+            if (_allocator != other._allocator)
+                release_heap();
+            _allocator = other._allocator;
+        }
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            alloc_traits::construct(_allocator, _data + _size, other._data[_size]);
+        }
+        return *this;
+    }
+
+    //Move assignment operator
+    small_vector_t &operator=(small_vector_t &&other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+        if constexpr (propagate) {
+            release_heap();
+            _allocator = std::move(other._allocator);
+        }
+        if (!other.is_inline() &&
+            (propagate || alloc_traits::is_always_equal::value ||
+             _allocator == other._allocator)) {
+            release_heap();
+            steal(other);
+        } else {
+            move_values(other);
+        }
+        return *this;
+    }
+
+    /// Exchanges the contents of two vectors. Inline values are moved one by
+    /// one.
+    void swap(small_vector_t &other) {
+        small_vector_t tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(small_vector_t &a, small_vector_t &b) { a.swap(b); }
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Tells whether the values are stored inside the object.
+    bool is_inline() const noexcept {
+        return _data == reinterpret_cast<T const *>(_inline);
+    }
+
+    /// Returns a pointer as an iterator to the beginning of the vector.
+    T *begin() { return _data; }
+
+    /// Returns a pointer as an iterator to the end of the vector.
+    T *end() { return _data + _size; }
+
+    /// Returns a constant pointer as an iterator to the beginning of the vector.
+    T const *begin() const { return _data; }
+
+    /// Returns a constant pointer as an iterator to the end of the vector.
+    T const *end() const { return _data + _size; }
+
+    /// Returns the size of the vector.
+    std::size_t size() const { return _size; }
+
+    /// Returns the capacity of the memory buffer.
+    std::size_t capacity() const { return _capacity; }
+
+    /// Non-const element access for getting and modifying elements.
+    T &operator[](std::size_t i) { return _data[i]; }
+
+    /// Read-only element access.
+    T const &operator[](std::size_t i) const { return _data[i]; }
+
+    /// Constructs a new element at the end of the vector, doubling the
+    /// capacity when it is insufficient. The first spill to the heap therefore
+    /// allocates room for 2 * N values.
+    template<typename... Args>
+    void emplace_back(Args &&...args) {
+        if (_size == _capacity)
+            reserve(2 * _capacity);
+        alloc_traits::construct(_allocator, end(), std::forward<Args>(args)...);
+        _size++;
+    }
+
+    /// Changes the capacity of the vector, moving to the heap if new_capacity
+    /// exceeds N. The capacity is never decreased.
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > _capacity)
+            relocate(new_capacity);
+    }
+
+    /// Sets the size of the vector, destroying or value-initializing[1] values
+    /// as necessary.
+    void resize(std::size_t new_size) {
+        if (new_size > _capacity)
+            reserve(new_size);
+        construct_tail(new_size);
+        destroy_tail(new_size);
+    }
+
+    /// Destroys the values and deallocates the heap buffer, if any.
+    ~small_vector_t() {
+        destroy_tail(0);
+        release_heap();
+    }
+};
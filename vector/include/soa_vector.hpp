@@ -0,0 +1,684 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// soa_vector_t ----------------------------------------------------------------
+
+// soa_vector_t<Ts...> is a vector of rows made of one value of each of Ts...,
+// stored as a structure of arrays: the values of each type are contiguous in
+// their own column, so that a loop over one field only reads that field. This
+// is what vector_t<struct> wastes cache bandwidth on when scanning one member
+// at a time.
+
+// The columns share a single buffer, allocated with an allocator of bytes.
+// Column k starts right after column k - 1, at an offset rounded up to
+// column_alignment bytes, so that each column starts on its own cache line
+// whenever the buffer does. Types aligned on more than the allocator
+// guarantees (16 bytes for operator new) are not supported.
+
+// It follows the invariants and lifetime rules of vector_t (see vector.hpp),
+// applied to whole rows:
+// - _size is the number of rows whose values are all alive,
+// - the capacity is the number of rows each column can hold, and grows like
+// vector_t, through reserve() and the growth policy,
+// - relocating the buffer moves each column, with a single memcpy for
+// trivially relocatable types,
+// - if constructing a value of a row throws, the values already constructed
+// in that row are destroyed, so that no partial row is ever left behind.
+
+// soa[i] returns a std::tuple of references to the values of row i, which
+// works with structured bindings, std::get, and assigns through to the row.
+// column<k>() returns the live values of column k as a std::span.
+
+template<typename Allocator, typename GrowthPolicy, typename... Ts>
+struct basic_soa_vector_t {
+public:
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+
+    /// Row of values, as a tuple of references.
+    using reference = std::tuple<Ts &...>;
+    using const_reference = std::tuple<Ts const &...>;
+
+    /// Number of columns.
+    static constexpr std::size_t column_count = sizeof...(Ts);
+
+    /// Type of the values of column K.
+    template<std::size_t K>
+    using column_type = std::tuple_element_t<K, std::tuple<Ts...>>;
+
+    /// Alignment of the column offsets in the buffer, in bytes.
+    static constexpr std::size_t column_alignment = 64;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(sizeof...(Ts) > 0, "soa_vector_t: there must be at least one column");
+    static_assert(std::is_same_v<typename alloc_traits::value_type, std::byte>,
+                  "soa_vector_t: Allocator::value_type must be std::byte");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, std::byte *>,
+                  "soa_vector_t: fancy pointers are not supported");
+    static_assert(((alignof(Ts) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) && ...),
+                  "soa_vector_t: over-aligned values are not supported");
+
+    using columns_t = std::tuple<Ts *...>;
+
+    /// Buffer holding every column, or nullptr.
+    std::byte *_data;
+
+    /// First value of each column, in _data.
+    columns_t _columns;
+
+    /// Number of live rows.
+    std::size_t _size;
+
+    /// Number of rows each column can hold.
+    std::size_t _capacity;
+
+    /// Memory allocator.
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Calls fn(std::integral_constant<std::size_t, K>()) for each column K.
+    template<typename Fn>
+    static void for_each_column(Fn &&fn) {
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            (fn(std::integral_constant<std::size_t, K>()), ...);
+        }(std::index_sequence_for<Ts...>());
+    }
+
+    /// Room taken by a column of capacity values of size bytes each.
+    static constexpr std::size_t column_bytes(std::size_t capacity, std::size_t size) noexcept {
+        return (capacity * size + column_alignment - 1) / column_alignment * column_alignment;
+    }
+
+    /// Size of a buffer holding capacity rows.
+    static constexpr std::size_t buffer_bytes(std::size_t capacity) noexcept {
+        return (column_bytes(capacity, sizeof(Ts)) + ...);
+    }
+
+    /// Returns the first value of each column in a buffer of capacity rows.
+    static columns_t columns_of(std::byte *buffer, std::size_t capacity) noexcept {
+        columns_t columns{};
+        if (!buffer)
+            return columns;
+        std::size_t offset = 0;
+        for_each_column([&](auto k) {
+            using T = column_type<k>;
+            std::get<k>(columns) = reinterpret_cast<T *>(buffer + offset);
+            offset += column_bytes(capacity, sizeof(T));
+        });
+        return columns;
+    }
+
+    /// Rows are zeroed with a memset per column if every column is zero
+    /// initializable (see "Zero initialization" in vector.hpp).
+    static constexpr bool zero_initializable = (is_zero_initializable_v<Ts> && ...);
+
+    /// Destroys[1] the values of the first count columns of row i.
+    void destroy_row(std::size_t i, std::size_t count) noexcept {
+        for_each_column([&](auto k) {
+            if constexpr (!std::is_trivially_destructible_v<column_type<k>>) {
+                if (k < count)
+                    alloc_traits::destroy(_allocator, std::get<k>(_columns) + i);
+            }
+        });
+    }
+
+    /// Constructs the values of row i from one argument per column, or
+    /// value-initializes them if there are no arguments. If a constructor
+    /// throws, the values already constructed are destroyed.
+    template<typename... Args>
+    void construct_row(std::size_t i, Args &&...args) {
+        static_assert(sizeof...(Args) == 0 || sizeof...(Args) == sizeof...(Ts),
+                      "soa_vector_t: a row takes one value per column");
+        auto arguments = std::forward_as_tuple(std::forward<Args>(args)...);
+        std::size_t constructed = 0;
+        try {
+            for_each_column([&](auto k) {
+                if constexpr (sizeof...(Args) == 0) {
+                    alloc_traits::construct(_allocator, std::get<k>(_columns) + i);
+                } else {
+                    alloc_traits::construct(_allocator, std::get<k>(_columns) + i,
+                                            std::get<k>(std::move(arguments)));
+                }
+                constructed++;
+            });
+        } catch (...) {
+            destroy_row(i, constructed);
+            throw;
+        }
+    }
+
+    /// Value-initializes[1] the rows of rank _size to new_size - 1, with a
+    /// memset per column if every column is zero initializable. The buffer
+    /// must be large enough.
+    void construct_tail(std::size_t new_size) {
+        if constexpr (zero_initializable) {
+            if (new_size > _size) {
+                for_each_column([&](auto k) {
+                    std::memset(static_cast<void *>(std::get<k>(_columns) + _size), 0,
+                                (new_size - _size) * sizeof(column_type<k>));
+                });
+                _size = new_size;
+            }
+        } else {
+            for (; _size < new_size; _size++) {
+                construct_row(_size);
+            }
+        }
+    }
+
+    /// Destroys[1] the rows of rank new_size to _size - 1.
+    void destroy_tail(std::size_t new_size) noexcept {
+        for (; _size > new_size; _size--) {
+            destroy_row(_size - 1, column_count);
+        }
+    }
+
+    /// Destroys every row and deallocates the buffer, leaving the vector
+    /// empty with no capacity.
+    void release() noexcept {
+        if (_data) {
+            destroy_tail(0);
+            alloc_traits::deallocate(_allocator, _data, buffer_bytes(_capacity));
+        }
+        _data = nullptr;
+        _columns = columns_t{};
+        _size = 0;
+        _capacity = 0;
+    }
+
+    /// Takes ownership of the buffer of other, leaving it empty.
+    /// The current buffer must have been released beforehand.
+    void steal(basic_soa_vector_t &other) noexcept {
+        _data = std::exchange(other._data, nullptr);
+        _columns = std::exchange(other._columns, columns_t{});
+        _size = std::exchange(other._size, 0);
+        _capacity = std::exchange(other._capacity, 0);
+    }
+
+    /// Copies or moves the rows of other one by one, after the live ones.
+    template<typename Other>
+    void construct_values(Other &&other) {
+        reserve(_size + other._size);
+        for (std::size_t i = 0; i < other._size; i++) {
+            std::apply([&](auto &...values) {
+                if constexpr (std::is_rvalue_reference_v<Other &&>)
+                    construct_row(_size, std::move(values)...);
+                else
+                    construct_row(_size, values...);
+            }, other[i]);
+            _size++;
+        }
+    }
+
+    /// Moves the live rows to a buffer of new_capacity rows, column by column,
+    /// and releases the old one. Trivially relocatable columns are moved with
+    /// a single memcpy, the others are moved one by one, then destroyed[1].
+    void relocate(std::size_t new_capacity) {
+        std::byte *new_data = alloc_traits::allocate(_allocator, buffer_bytes(new_capacity));
+        columns_t const new_columns = columns_of(new_data, new_capacity);
+        for_each_column([&](auto k) {
+            using T = column_type<k>;
+            T *source = std::get<k>(_columns);
+            T *target = std::get<k>(new_columns);
+            if constexpr (is_trivially_relocatable_v<T>) {
+                if (_size)
+                    std::memcpy(static_cast<void *>(target), static_cast<void const *>(source),
+                                _size * sizeof(T));
+            } else {
+                for (std::size_t i = 0; i < _size; i++) {
+                    alloc_traits::construct(_allocator, target + i, std::move(source[i]));
+                }
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    for (std::size_t i = 0; i < _size; i++) {
+                        alloc_traits::destroy(_allocator, source + i);
+                    }
+                }
+            }
+        });
+        if (_data)
+            alloc_traits::deallocate(_allocator, _data, buffer_bytes(_capacity));
+        _data = new_data;
+        _columns = new_columns;
+        _capacity = new_capacity;
+    }
+
+public:
+    /// Initializes an empty vector with no capacity.
+    basic_soa_vector_t() noexcept(noexcept(Allocator()))
+        : _data(nullptr), _columns{}, _size(0), _capacity(0), _allocator() {}
+
+    explicit basic_soa_vector_t(Allocator const &alloc) noexcept
+        : _data(nullptr), _columns{}, _size(0), _capacity(0), _allocator(alloc) {}
+
+    /// Initializes a vector of s value-initialized[1] rows, with a capacity
+    /// of s rows.
+    explicit basic_soa_vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : basic_soa_vector_t(alloc) {
+        resize(s);
+    }
+
+    //copy constructor
+    basic_soa_vector_t(basic_soa_vector_t const &other)
+        : basic_soa_vector_t(alloc_traits::select_on_container_copy_construction(
+              other._allocator)) {
+        construct_values(other);
+    }
+
+    //move constructor
+    basic_soa_vector_t(basic_soa_vector_t &&other) noexcept
+        : basic_soa_vector_t(std::move(other._allocator)) {
+        steal(other);
+    }
+
+    //copy assignment operator: the current buffer is reused if it is large
+    //enough
+    basic_soa_vector_t &operator=(basic_soa_vector_t const &other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            //the current buffer belongs to the old allocator
+            if (!alloc_traits::is_always_equal::value && _allocator != other._allocator)
+                release();
+            _allocator = other._allocator;
+        }
+        construct_values(other);
+        return *this;
+    }
+
+    //Move assignment operator
+    basic_soa_vector_t &operator=(basic_soa_vector_t &&other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other)
+            return *this;
+        release();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            _allocator = std::move(other._allocator);
+        } else if (!alloc_traits::is_always_equal::value &&
+                   _allocator != other._allocator) {
+            //the buffer of other cannot be handed over to our allocator
+            construct_values(std::move(other));
+            return *this;
+        }
+        steal(other);
+        return *this;
+    }
+
+    /// Exchanges the contents of two vectors. Allocators are only swapped if
+    /// they propagate on swap, otherwise they must compare equal.
+    void swap(basic_soa_vector_t &other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(_allocator, other._allocator);
+        }
+        swap(_data, other._data);
+        swap(_columns, other._columns);
+        swap(_size, other._size);
+        swap(_capacity, other._capacity);
+    }
+
+    friend void swap(basic_soa_vector_t &a, basic_soa_vector_t &b) noexcept { a.swap(b); }
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Returns the number of rows.
+    std::size_t size() const { return _size; }
+
+    /// Returns the number of rows the buffer can hold.
+    std::size_t capacity() const { return _capacity; }
+
+    /// Returns the live values of column K.
+    template<std::size_t K>
+    std::span<column_type<K>> column() noexcept {
+        return {std::get<K>(_columns), _size};
+    }
+
+    /// Returns the live values of column K.
+    template<std::size_t K>
+    std::span<column_type<K> const> column() const noexcept {
+        return {std::get<K>(_columns), _size};
+    }
+
+    /// Returns references to the values of row i.
+    reference operator[](std::size_t i) noexcept {
+        return std::apply([i](Ts *...columns) { return reference(columns[i]...); }, _columns);
+    }
+
+    /// Returns constant references to the values of row i.
+    const_reference operator[](std::size_t i) const noexcept {
+        return std::apply([i](Ts *...columns) { return const_reference(columns[i]...); },
+                          _columns);
+    }
+
+    /// Constructs a new row at the end of the vector from one argument per
+    /// column, and returns it. If the capacity is insufficient, the growth
+    /// policy decides of the new capacity, like for vector_t.
+    template<typename... Args>
+        requires(sizeof...(Args) == sizeof...(Ts))
+    reference emplace_back(Args &&...args) {
+        if (_size == _capacity)
+            reserve(GrowthPolicy::template next_capacity<std::tuple<Ts...>>(_capacity));
+        construct_row(_size, std::forward<Args>(args)...);
+        return (*this)[_size++];
+    }
+
+    /// Grows the buffer to new_capacity rows if it is smaller, relocating the
+    /// live rows. Never shrinks the buffer.
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > _capacity)
+            relocate(new_capacity);
+    }
+
+    /// Sets the number of rows, destroying or value-initializing[1] rows as
+    /// necessary, and reserving memory as needed.
+    void resize(std::size_t new_size) {
+        reserve(new_size);
+        construct_tail(new_size);
+        destroy_tail(new_size);
+    }
+
+    /// Destroys the rows and deallocates the buffer.
+    ~basic_soa_vector_t() { release(); }
+};
+
+/// Structure of arrays with the default allocator and growth policy of
+/// vector_t.
+template<typename... Ts>
+using soa_vector_t = basic_soa_vector_t<std::allocator<std::byte>, doubling_growth_t<>, Ts...>;
+
+// Aggregate structs -----------------------------------------------------------
+
+// soa_struct_vector_t<T> is a soa_vector_t whose columns are the fields of
+// the aggregate struct T, so that domain types keep their field names:
+//
+//     struct order_t { std::int64_t id; float price; float quantity; };
+//     soa_struct_vector_t<order_t> orders;
+//     orders.push_back(order_t{1, 9.5f, 100.f});
+//     std::span<float> prices = orders.col<&order_t::price>();
+
+// The fields are found without any declaration, like std::tuple_size would
+// for a tuple:
+// - their number is the largest N for which T{v_1, ..., v_N} compiles, with
+// v_i convertible to anything,
+// - they are then bound by a structured binding of that size, which gives
+// their types and references to them,
+// - col<&T::field>() finds the column of a pointer to member at compile
+// time, by comparing its address with the ones of the structured binding on
+// a declared but never defined object.
+
+// This works for aggregates without base classes, of up to
+// soa_struct_max_fields non-static data members that are neither references
+// nor arrays (brace elision would count each element of an array as a field).
+// Other structs fail to compile, and so does col() on structs local to a
+// function, which cannot have a declared but undefined object.
+
+// Rows are stored field by field, and follow the lifetime rules of
+// soa_vector_t: push_back(value) copies or moves each field of value into its
+// column, value(i) gathers row i back into a T.
+
+/// Largest number of fields of structs stored by soa_struct_vector_t.
+inline constexpr std::size_t soa_struct_max_fields = 16;
+
+namespace soa_detail {
+
+    /// Converts to any type, to count the fields of aggregates.
+    struct any_t {
+        template<typename U>
+        operator U() const;
+    };
+
+    /// Returns the number of fields of the aggregate T.
+    template<typename T, std::size_t N = soa_struct_max_fields>
+    consteval std::size_t field_count() {
+        if constexpr (N == 0) {
+            return 0;
+        } else {
+            return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                if constexpr (requires { T{(void(I), any_t())...}; })
+                    return N;
+                else
+                    return field_count<T, N - 1>();
+            }(std::make_index_sequence<N>());
+        }
+    }
+
+    /// Returns a tuple of references to the fields of value.
+    template<typename T>
+    constexpr auto tie_fields(T &value) noexcept {
+        constexpr std::size_t n = field_count<std::remove_cv_t<T>>();
+        static_assert(n > 0, "soa_struct_vector_t: structs must have at least one field");
+        if constexpr (n == 1) {
+            auto &[f0] = value;
+            return std::tie(f0);
+        } else if constexpr (n == 2) {
+            auto &[f0, f1] = value;
+            return std::tie(f0, f1);
+        } else if constexpr (n == 3) {
+            auto &[f0, f1, f2] = value;
+            return std::tie(f0, f1, f2);
+        } else if constexpr (n == 4) {
+            auto &[f0, f1, f2, f3] = value;
+            return std::tie(f0, f1, f2, f3);
+        } else if constexpr (n == 5) {
+            auto &[f0, f1, f2, f3, f4] = value;
+            return std::tie(f0, f1, f2, f3, f4);
+        } else if constexpr (n == 6) {
+            auto &[f0, f1, f2, f3, f4, f5] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5);
+        } else if constexpr (n == 7) {
+            auto &[f0, f1, f2, f3, f4, f5, f6] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6);
+        } else if constexpr (n == 8) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+        } else if constexpr (n == 9) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8);
+        } else if constexpr (n == 10) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9);
+        } else if constexpr (n == 11) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+        } else if constexpr (n == 12) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11);
+        } else if constexpr (n == 13) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12);
+        } else if constexpr (n == 14) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13);
+        } else if constexpr (n == 15) {
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14);
+        } else {
+            static_assert(n == 16);
+            auto &[f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] =
+                value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14,
+                            f15);
+        }
+    }
+
+    /// Types of the fields referenced by a tuple of references.
+    template<typename Tie>
+    struct field_types;
+
+    template<typename... Fs>
+    struct field_types<std::tuple<Fs &...>> {
+        using type = std::tuple<std::remove_cv_t<Fs>...>;
+    };
+
+    /// Tuple of the field types of T.
+    template<typename T>
+    using fields_t = typename field_types<decltype(tie_fields(std::declval<T &>()))>::type;
+
+    /// basic_soa_vector_t with a column per field of T.
+    template<typename Allocator, typename GrowthPolicy, typename T, typename Fields = fields_t<T>>
+    struct columns_of;
+
+    template<typename Allocator, typename GrowthPolicy, typename T, typename... Fs>
+    struct columns_of<Allocator, GrowthPolicy, T, std::tuple<Fs...>> {
+        using type = basic_soa_vector_t<Allocator, GrowthPolicy, Fs...>;
+    };
+
+    /// Declared but never defined object, whose fields have addresses at
+    /// compile time.
+    template<typename T>
+    extern T const fake_object;
+
+    /// Returns the index of the field Member points to.
+    template<typename T, auto Member>
+    consteval std::size_t field_index() {
+        auto const fields = tie_fields(fake_object<T>);
+        void const *const address = &(fake_object<T>.*Member);
+        return [&]<std::size_t... K>(std::index_sequence<K...>) {
+            std::size_t index = sizeof...(K);
+            ((static_cast<void const *>(&std::get<K>(fields)) == address && (index = K, true)) ||
+             ...);
+            return index;
+        }(std::make_index_sequence<std::tuple_size_v<decltype(fields)>>());
+    }
+
+    /// Type of the field a pointer to member of T points to.
+    template<typename T, typename Member>
+    struct member_type;
+
+    template<typename T, typename F>
+    struct member_type<T, F T::*> {
+        using type = F;
+    };
+
+} // namespace soa_detail
+
+template<typename T, typename Allocator = std::allocator<std::byte>,
+         typename GrowthPolicy = doubling_growth_t<>>
+struct soa_struct_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using columns_type = typename soa_detail::columns_of<Allocator, GrowthPolicy, T>::type;
+
+    /// Row of fields, as a tuple of references.
+    using reference = typename columns_type::reference;
+    using const_reference = typename columns_type::const_reference;
+
+    /// Number of fields of T.
+    static constexpr std::size_t column_count = columns_type::column_count;
+
+private:
+    static_assert(std::is_aggregate_v<T> && !std::is_union_v<T> && !std::is_const_v<T>,
+                  "soa_struct_vector_t: T must be an aggregate struct");
+
+    /// Column of each field.
+    columns_type _columns;
+
+public:
+    soa_struct_vector_t() = default;
+
+    explicit soa_struct_vector_t(Allocator const &alloc) noexcept : _columns(alloc) {}
+
+    /// Initializes a vector of s value-initialized[1] rows.
+    explicit soa_struct_vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : _columns(s, alloc) {}
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _columns.get_allocator(); }
+
+    /// Returns the underlying soa_vector_t, for code written against columns
+    /// by rank.
+    columns_type &columns() noexcept { return _columns; }
+    columns_type const &columns() const noexcept { return _columns; }
+
+    /// Returns the number of rows.
+    std::size_t size() const { return _columns.size(); }
+
+    /// Returns the number of rows the buffer can hold.
+    std::size_t capacity() const { return _columns.capacity(); }
+
+    /// Returns the live values of the field Member points to, eg.
+    /// col<&order_t::price>().
+    template<auto Member>
+    std::span<typename soa_detail::member_type<T, decltype(Member)>::type> col() noexcept {
+        constexpr std::size_t k = soa_detail::field_index<T, Member>();
+        static_assert(k < column_count, "soa_struct_vector_t: not a field of T");
+        return _columns.template column<k>();
+    }
+
+    /// Returns the live values of the field Member points to.
+    template<auto Member>
+    std::span<typename soa_detail::member_type<T, decltype(Member)>::type const>
+    col() const noexcept {
+        constexpr std::size_t k = soa_detail::field_index<T, Member>();
+        static_assert(k < column_count, "soa_struct_vector_t: not a field of T");
+        return _columns.template column<k>();
+    }
+
+    /// Returns the live values of field K, in declaration order.
+    template<std::size_t K>
+    auto column() noexcept {
+        return _columns.template column<K>();
+    }
+
+    template<std::size_t K>
+    auto column() const noexcept {
+        return _columns.template column<K>();
+    }
+
+    /// Returns references to the fields of row i.
+    reference operator[](std::size_t i) noexcept { return _columns[i]; }
+    const_reference operator[](std::size_t i) const noexcept { return _columns[i]; }
+
+    /// Returns a copy of row i, gathered from the columns.
+    T value(std::size_t i) const {
+        return std::apply([](auto const &...fields) { return T{fields...}; }, _columns[i]);
+    }
+
+    /// Copies the fields of value into a new row at the end of the vector.
+    reference push_back(T const &value) {
+        return std::apply(
+            [this](auto const &...fields) -> reference { return _columns.emplace_back(fields...); },
+            soa_detail::tie_fields(value));
+    }
+
+    /// Moves the fields of value into a new row at the end of the vector.
+    reference push_back(T &&value) {
+        return std::apply(
+            [this](auto &...fields) -> reference {
+                return _columns.emplace_back(std::move(fields)...);
+            },
+            soa_detail::tie_fields(value));
+    }
+
+    /// Constructs a new row at the end of the vector from one argument per
+    /// field.
+    template<typename... Args>
+        requires(sizeof...(Args) == column_count)
+    reference emplace_back(Args &&...args) {
+        return _columns.emplace_back(std::forward<Args>(args)...);
+    }
+
+    /// Grows the buffer to new_capacity rows if it is smaller.
+    void reserve(std::size_t new_capacity) { _columns.reserve(new_capacity); }
+
+    /// Sets the number of rows, value-initializing[1] new rows.
+    void resize(std::size_t new_size) { _columns.resize(new_size); }
+
+    /// Exchanges the contents of two vectors.
+    void swap(soa_struct_vector_t &other) noexcept { _columns.swap(other._columns); }
+
+    friend void swap(soa_struct_vector_t &a, soa_struct_vector_t &b) noexcept { a.swap(b); }
+};
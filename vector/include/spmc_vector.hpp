@@ -0,0 +1,283 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+// spmc_vector_t ---------------------------------------------------------------
+
+// spmc_vector_t<T> is an append-only vector with a single writer thread and
+// any number of reader threads, none of which ever takes a lock. Unlike
+// concurrent_vector_t, values are contiguous like in vector_t: readers get a
+// plain pointer and size.
+
+// The writer publishes values with release/acquire semantics: a value is
+// constructed, then _size is incremented, so readers that load _size see every
+// value below it fully constructed.
+
+// Growing the buffer cannot free the old one, since readers may still be
+// reading it, nor move from its values. The writer copies the values to the
+// new buffer, publishes it, and retires the old one, which is destroyed and
+// deallocated later by epoch-based reclamation:
+// - a global epoch is incremented every time a buffer is retired, and retired
+// buffers are tagged with the new epoch,
+// - a reader pins the current epoch in one of MaxReaders slots before loading
+// the buffer, and clears its slot when it is done,
+// - a retired buffer is reclaimed once no slot holds an older epoch: readers
+// that pinned a later epoch can only have loaded a later buffer.
+// The epochs, slots and buffer pointer use sequentially consistent operations,
+// which this argument relies on.
+
+// Readers take a snapshot_t, which pins a slot for its lifetime and gives
+// access to the values published when it was taken. At most MaxReaders
+// snapshots can be alive at once, and taking another one waits for a slot to
+// be freed. Long-lived snapshots delay reclamation, not the writer.
+
+// Only the writer may call emplace_back(), reserve() and reclaim(). The values
+// are only ever accessed through const references, since readers may be
+// reading them.
+
+template<typename T, typename Allocator = std::allocator<T>, std::size_t MaxReaders = 64>
+struct spmc_vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    static_assert(std::is_copy_constructible_v<T>,
+                  "spmc_vector_t: values are copied when the buffer grows");
+    static_assert(MaxReaders > 0, "spmc_vector_t: there must be at least one reader slot");
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "spmc_vector_t: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T *>,
+                  "spmc_vector_t: fancy pointers are not supported");
+
+    /// Epoch pinned by a reader, or 0 if the slot is free. Slots are on their
+    /// own cache line, so that readers do not slow each other down.
+    struct alignas(64) reader_slot_t {
+        std::atomic<std::uint64_t> epoch{0};
+    };
+
+    /// Buffer waiting for reclamation.
+    struct retired_t {
+        T *data;
+        std::size_t size;
+        std::size_t capacity;
+        std::uint64_t epoch;
+    };
+
+    /// Current buffer, read by every thread.
+    std::atomic<T *> _data{nullptr};
+
+    /// Published size: the first _size values are alive.
+    std::atomic<std::size_t> _size{0};
+
+    /// Capacity of the current buffer, only used by the writer.
+    std::size_t _capacity = 0;
+
+    /// Global epoch, starting at 1 since 0 marks free slots.
+    std::atomic<std::uint64_t> _epoch{1};
+
+    /// Epochs pinned by readers, which only take const references to the
+    /// vector.
+    mutable reader_slot_t _slots[MaxReaders];
+
+    /// Buffers retired by the writer and not reclaimed yet.
+    vector_t<retired_t> _retired;
+
+    /// Memory allocator, only used by the writer.
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Destroys[1] the values of a buffer and deallocates it.
+    void free_buffer(T *data, std::size_t size, std::size_t capacity) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (std::size_t i = 0; i < size; i++) {
+                alloc_traits::destroy(_allocator, data + i);
+            }
+        }
+        alloc_traits::deallocate(_allocator, data, capacity);
+    }
+
+    /// Copies the values to a buffer that can hold new_capacity values,
+    /// publishes it, and retires the old one.
+    void grow(std::size_t new_capacity) {
+        T *old_data = _data.load(std::memory_order_relaxed);
+        std::size_t const size = _size.load(std::memory_order_relaxed);
+        T *new_data = alloc_traits::allocate(_allocator, new_capacity);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size)
+                std::memcpy(static_cast<void *>(new_data), static_cast<void const *>(old_data),
+                            size * sizeof(T));
+        } else {
+            std::size_t copied = 0;
+            try {
+                for (; copied < size; copied++) {
+                    alloc_traits::construct(_allocator, new_data + copied, old_data[copied]);
+                }
+            } catch (...) {
+                free_buffer(new_data, copied, new_capacity);
+                throw;
+            }
+        }
+        _data.store(new_data);
+        std::size_t const old_capacity = std::exchange(_capacity, new_capacity);
+        if (old_data) {
+            //readers pinning the new epoch can only see new_data
+            std::uint64_t const epoch = _epoch.fetch_add(1) + 1;
+            _retired.emplace_back(retired_t{old_data, size, old_capacity, epoch});
+            reclaim();
+        }
+    }
+
+    /// Pins the current epoch in a free slot, and returns the slot.
+    reader_slot_t &pin() const noexcept {
+        std::size_t i = std::hash<std::thread::id>()(std::this_thread::get_id()) % MaxReaders;
+        for (;;) {
+            for (std::size_t n = 0; n < MaxReaders; n++, i = (i + 1) % MaxReaders) {
+                std::uint64_t free = 0;
+                if (_slots[i].epoch.load(std::memory_order_relaxed) == 0 &&
+                    _slots[i].epoch.compare_exchange_strong(free, _epoch.load()))
+                    return _slots[i];
+            }
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    /// Values published when the snapshot was taken. The snapshot keeps its
+    /// buffer from being reclaimed until it is destroyed.
+    struct snapshot_t {
+    private:
+        friend spmc_vector_t;
+
+        reader_slot_t *_slot;
+        T const *_data;
+        std::size_t _size;
+
+        explicit snapshot_t(spmc_vector_t const &vec) noexcept : _slot(&vec.pin()) {
+            //the size is loaded first: the buffer is at least as recent as the
+            //one holding the first _size values
+            _size = vec._size.load();
+            _data = vec._data.load();
+        }
+
+    public:
+        snapshot_t(snapshot_t const &) = delete;
+        snapshot_t &operator=(snapshot_t const &) = delete;
+
+        snapshot_t(snapshot_t &&other) noexcept
+            : _slot(std::exchange(other._slot, nullptr)), _data(other._data), _size(other._size) {}
+
+        /// Returns a constant pointer as an iterator to the beginning of the
+        /// snapshot.
+        T const *begin() const noexcept { return _data; }
+
+        /// Returns a constant pointer as an iterator to the end of the
+        /// snapshot.
+        T const *end() const noexcept { return _data + _size; }
+
+        /// Returns the number of values in the snapshot.
+        std::size_t size() const noexcept { return _size; }
+
+        /// Read-only element access.
+        T const &operator[](std::size_t i) const noexcept { return _data[i]; }
+
+        /// Unpins the epoch of the snapshot.
+        ~snapshot_t() {
+            if (_slot)
+                _slot->epoch.store(0);
+        }
+    };
+
+    /// Initializes an empty vector with no buffer.
+    spmc_vector_t() noexcept(noexcept(Allocator())) : _allocator() {}
+
+    explicit spmc_vector_t(Allocator const &alloc) noexcept : _allocator(alloc) {}
+
+    spmc_vector_t(spmc_vector_t const &) = delete;
+    spmc_vector_t &operator=(spmc_vector_t const &) = delete;
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Takes a snapshot of the published values. Can be called from any
+    /// thread.
+    snapshot_t snapshot() const noexcept { return snapshot_t(*this); }
+
+    /// Returns the published size. Can be called from any thread.
+    std::size_t size() const noexcept { return _size.load(std::memory_order_acquire); }
+
+    /// Returns the capacity of the current buffer. Writer only.
+    std::size_t capacity() const noexcept { return _capacity; }
+
+    /// Returns the number of retired buffers that are not reclaimed yet.
+    /// Writer only.
+    std::size_t retired_count() const noexcept { return _retired.size(); }
+
+    /// Read-only element access for the writer.
+    T const &operator[](std::size_t i) const noexcept {
+        return _data.load(std::memory_order_relaxed)[i];
+    }
+
+    /// Constructs a new element at the end of the vector, and publishes it.
+    /// Writer only.
+    template<typename... Args>
+    void emplace_back(Args &&...args) {
+        std::size_t const size = _size.load(std::memory_order_relaxed);
+        if (size == _capacity)
+            grow(doubling_growth_t<>::next_capacity<T>(_capacity));
+        alloc_traits::construct(_allocator, _data.load(std::memory_order_relaxed) + size,
+                                std::forward<Args>(args)...);
+        _size.store(size + 1, std::memory_order_release);
+    }
+
+    /// Grows the buffer to at least new_capacity values. Writer only.
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > _capacity)
+            grow(new_capacity);
+    }
+
+    /// Destroys and deallocates the retired buffers that no reader can be
+    /// using anymore. This is done on every growth, and can be called by the
+    /// writer at any time. Returns the number of buffers that are still
+    /// retired.
+    std::size_t reclaim() noexcept {
+        std::uint64_t oldest = _epoch.load();
+        for (auto const &slot : _slots) {
+            std::uint64_t const epoch = slot.epoch.load();
+            if (epoch != 0 && epoch < oldest)
+                oldest = epoch;
+        }
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < _retired.size(); i++) {
+            retired_t const r = _retired[i];
+            if (r.epoch <= oldest)
+                free_buffer(r.data, r.size, r.capacity);
+            else
+                _retired[kept++] = r;
+        }
+        _retired.resize(kept);
+        return kept;
+    }
+
+    /// Destroys the values and deallocates every buffer. No snapshot may be
+    /// alive anymore.
+    ~spmc_vector_t() {
+        for (auto const &r : _retired) {
+            free_buffer(r.data, r.size, r.capacity);
+        }
+        if (T *data = _data.load())
+            free_buffer(data, _size.load(), _capacity);
+    }
+};
@@ -1,7 +1,16 @@
 #pragma once
 
+#include <concepts>
+#include <cstddef>
+#include <cstring>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
+#include <utility>
+
+#include "aligned_allocator.hpp"
+#include "allocator_extensions.hpp"
+#include "vector_stats.hpp"
 
 //Fedy Ben Naceur---------------------M1 Data Science
 
@@ -86,6 +95,16 @@
 // (https://en.cppreference.com/w/cpp/types/is_destructible) or
 // std::is_trivially_default_constructible.
 
+// vector_t does so with if constexpr: trivially destructible values are never
+// destroyed, and trivial values are value-initialized with a single memset.
+// resize_for_overwrite() and the default_init constructor go one step further
+// and leave trivially default constructible values uninitialized. Note that
+// this bypasses Allocator::construct for these values, and that trivially
+// destructible values also bypass Allocator::destroy. Other values are
+// default-initialized through Allocator::construct when the allocator
+// provides one, so that allocators like std::pmr::polymorphic_allocator pass
+// themselves on to nested containers.
+
 // Consider destroyed values like uninitialized values. If you want to reuse the
 // storage of a value that has been previously destroyed, you should initialize
 // it first using std::construct_at.
@@ -100,6 +119,17 @@
 
 // All the memory management should be done through _allocator.
 
+// _allocator is of type Allocator (std::allocator<T> by default), and is only
+// ever used through std::allocator_traits<Allocator>, which provides defaults
+// for everything a minimal allocator leaves out. This also means values are
+// constructed and destroyed with alloc_traits::construct and
+// alloc_traits::destroy, which fall back to std::construct_at and
+// std::destroy_at. Stateful allocators are supported: the
+// propagate_on_container_copy_assignment, propagate_on_container_move_assignment
+// and propagate_on_container_swap traits decide whether the allocator follows
+// the values on assignment and swap. A buffer must always be deallocated by an
+// allocator that compares equal to the one that allocated it.
+
 //  - Allocation
 
 // Allocating basically means asking your OS for heap storage. What you get when
@@ -118,6 +148,10 @@
 // anymore. Deallocating memory does not destroy the objects, and destruction
 // must be done before deallocating.
 
+// Every allocation and deallocation goes through allocate(),
+// allocate_at_least() and deallocate(), which also feed the statistics
+// described in vector_stats.hpp when VECTOR_T_STATS is defined.
+
 // C++17-compatible, non-constexpr implementation of std::construct_at
 // (std::construct_at is a C++20 library feature)
 #ifndef __cpp_lib_constexpr_dynamic_alloc
@@ -130,9 +164,193 @@ inline T *construct_at(T *p, Args &&...args) {
 } // namespace std
 #endif
 
+// Relocation ------------------------------------------------------------------
+
+// Relocating a value means moving it to a new address and ending the lifetime
+// of the original, which is what reserve() does to every live value. For most
+// types, this amounts to copying bytes: ints and POD structs of course, but
+// also types like std::unique_ptr whose move constructor and destructor only
+// shuffle pointers around. Such types are said to be trivially relocatable.
+
+// vector_t relocates trivially relocatable values with std::memcpy, without
+// running any move constructor or destructor. Trivially copyable types are
+// trivially relocatable by default, and other types can opt in by
+// specializing is_trivially_relocatable:
+
+// template <> struct is_trivially_relocatable<my_type_t> : std::true_type {};
+
+// Types holding pointers to themselves or registering their own address
+// somewhere must *not* opt in.
+
+// Allocators may additionally resize buffers of trivially relocatable values
+// in place with a reallocate() member, like std::realloc (see
+// allocator_extensions.hpp and malloc_allocator_t in malloc_allocator.hpp).
+
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T, typename Deleter>
+struct is_trivially_relocatable<std::unique_ptr<T, Deleter>>
+    : is_trivially_relocatable<Deleter> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Zero initialization ---------------------------------------------------------
+
+// Value-initializing trivial values of a type whose value-initialized state
+// is all zero bytes amounts to a single memset over the whole range, which
+// vector_t and its siblings use in resize() and the sized constructors. That
+// is the case of arithmetic, enumeration and ordinary pointer types, but not
+// of pointers to data members, which are -1 on common ABIs, nor of the structs
+// that may hold them. Only scalar types other than pointers to members are
+// zero initializable by default. Other trivial types can opt in by
+// specializing is_zero_initializable:
+
+// template <> struct is_zero_initializable<my_type_t> : std::true_type {};
+
+// Values of the other types are value-initialized one by one.
+
 template<typename T>
+struct is_zero_initializable
+    : std::bool_constant<std::is_scalar_v<T> && !std::is_member_pointer_v<T>> {};
+
+template<typename T>
+inline constexpr bool is_zero_initializable_v = is_zero_initializable<T>::value;
+
+/// Tag selecting the constructors that default-initialize values instead of
+/// value-initializing them.
+struct default_init_t {
+    explicit default_init_t() = default;
+};
+
+inline constexpr default_init_t default_init{};
+
+// Value-initializing a huge vector on a single thread serializes the page
+// faults, and on NUMA machines puts every page on the node of that thread,
+// since pages are placed where they are first touched. The constructors and
+// resize() overloads taking a parallel_init_t initialize disjoint slices of
+// the new values on several threads instead, so that each page lands next to
+// the thread that touched it first. split(n, fn) must call fn(begin, end) on
+// disjoint ranges covering [0, n), possibly from several threads at once, and
+// return once all of them are done: parallel_init() in parallel.hpp builds
+// one running on a thread_pool_t.
+
+// Parallel initialization only kicks in for at least min_bytes of new values,
+// and for values whose default constructor cannot throw, so that a failure
+// never leaves holes in the live values. Other values are initialized on the
+// calling thread.
+
+/// Tag selecting the constructors and resize() overloads that value-initialize
+/// values on several threads.
+template<typename Splitter>
+struct parallel_init_t {
+    Splitter split;
+    std::size_t min_bytes = std::size_t(1) << 20;
+};
+
+// Allocators may also report how much room they actually handed out, resize
+// buffers in place, or guarantee a stronger alignment than alignof(T): these
+// optional members are described in allocator_extensions.hpp.
+
+// Growth policies -------------------------------------------------------------
+
+// When emplace_back() runs out of capacity, the vector asks its growth policy
+// for a new capacity. A growth policy is a type providing:
+
+// template <typename T>
+// static std::size_t next_capacity(std::size_t capacity);
+
+// which must return a capacity strictly greater than capacity, given that the
+// vector holds values of type T. The default policy reserves 16 values on
+// first insertion, then doubles the capacity.
+
+/// Multiplies the capacity by Num / Den, starting with Initial values.
+/// factor_growth_t<3, 2> grows by 1.5x, which lets the allocator reuse the
+/// blocks freed by previous growths: with a factor below the golden ratio, the
+/// sum of the previous blocks eventually exceeds the next request.
+template<std::size_t Num, std::size_t Den, std::size_t Initial = 16>
+struct factor_growth_t {
+    static_assert(Num > Den, "factor_growth_t: the growth factor must be > 1");
+    static_assert(Initial > 0, "factor_growth_t: the initial capacity must be > 0");
+
+    template<typename T>
+    static constexpr std::size_t next_capacity(std::size_t capacity) noexcept {
+        if (capacity == 0)
+            return Initial;
+        std::size_t const grown = capacity / Den * Num + capacity % Den * Num / Den;
+        return grown > capacity ? grown : capacity + 1;
+    }
+};
+
+/// The default growth policy: Initial values on first insertion, then 2x.
+template<std::size_t Initial = 16>
+using doubling_growth_t = factor_growth_t<2, 1, Initial>;
+
+/// Adds Increment values to the capacity, starting with Initial values.
+/// Growth is linear, so the memory overhead is bounded by Increment values,
+/// at the price of a quadratic number of moved values: this is meant for
+/// memory-capped processes, along with reserve().
+template<std::size_t Increment, std::size_t Initial = Increment>
+struct fixed_increment_growth_t {
+    static_assert(Increment > 0, "fixed_increment_growth_t: the increment must be > 0");
+    static_assert(Initial > 0, "fixed_increment_growth_t: the initial capacity must be > 0");
+
+    template<typename T>
+    static constexpr std::size_t next_capacity(std::size_t capacity) noexcept {
+        return capacity == 0 ? Initial : capacity + Increment;
+    }
+};
+
+/// Rounds a number of bytes up to the size classes used by most malloc
+/// implementations (jemalloc, tcmalloc, mimalloc...): multiples of 16 bytes,
+/// then four classes per power of two, then whole pages for large blocks
+/// which are mapped directly. Asking for less just wastes the slack.
+constexpr std::size_t round_to_size_class(std::size_t bytes) noexcept {
+    constexpr std::size_t page_size = 4096;
+    if (bytes <= 128)
+        return (bytes + 15) / 16 * 16;
+    if (bytes >= 32 * page_size)
+        return (bytes + page_size - 1) / page_size * page_size;
+    //the largest power of two below bytes
+    std::size_t power = 128;
+    while (power * 2 < bytes) {
+        power *= 2;
+    }
+    std::size_t const step = power / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+/// Grows by 1.5x like factor_growth_t<3, 2, Initial>, then rounds the
+/// capacity up so that the buffer fills a whole malloc size class.
+template<std::size_t Initial = 16>
+struct size_class_growth_t {
+    template<typename T>
+    static constexpr std::size_t next_capacity(std::size_t capacity) noexcept {
+        std::size_t const grown = factor_growth_t<3, 2, Initial>::template next_capacity<T>(capacity);
+        return round_to_size_class(grown * sizeof(T)) / sizeof(T);
+    }
+};
+
+template<typename T, typename Allocator = std::allocator<T>,
+         typename GrowthPolicy = doubling_growth_t<>>
 struct vector_t {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+
+    /// Alignment of the buffer, as guaranteed by the allocator.
+    static constexpr std::size_t alignment = allocator_alignment_v<Allocator, T>;
+
 private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "vector_t: Allocator::value_type must be T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T *>,
+                  "vector_t: fancy pointers are not supported");
+
     /// Pointer to the memory buffer.
     /// It should be either valid or equal nullptr.
     T *_data;
@@ -145,79 +363,355 @@ private:
     std::size_t _capacity;
 
     /// Memory allocator.
-    std::allocator<T> _allocator;
+    /// Stateless allocators take no room in the vector thanks to
+    /// [[no_unique_address]].
+    [[no_unique_address]] Allocator _allocator;
+
+    /// Destroys all the values that are alive and deallocates the buffer,
+    /// leaving the vector empty with no capacity.
+    void release() noexcept {
+        if (_data) {
+            destroy_tail(0);
+            deallocate(_data, _capacity);
+        }
+        _data = nullptr;
+        _size = 0;
+        _capacity = 0;
+    }
+
+    /// Value-initializes[1] the values of rank _size to new_size - 1, with a
+    /// single memset for zero initializable values (see "Zero
+    /// initialization"). The buffer must be large enough.
+    void construct_tail(std::size_t new_size) {
+        if constexpr (is_zero_initializable_v<T>) {
+            if (new_size > _size) {
+                std::memset(static_cast<void *>(_data + _size), 0,
+                            (new_size - _size) * sizeof(T));
+                _size = new_size;
+            }
+        } else {
+            for (; _size < new_size; _size++) {
+                alloc_traits::construct(_allocator, _data + _size);
+            }
+        }
+    }
+
+    /// Same as above, except that large ranges of values are value-initialized
+    /// in parallel slices by init.
+    template<typename Splitter>
+    void construct_tail(std::size_t new_size, parallel_init_t<Splitter> const &init) {
+        if constexpr (std::is_nothrow_default_constructible_v<T>) {
+            if (new_size > _size && (new_size - _size) * sizeof(T) >= init.min_bytes) {
+                T *first = _data + _size;
+                init.split(new_size - _size, [&](std::size_t begin, std::size_t end) {
+                    if constexpr (is_zero_initializable_v<T>) {
+                        std::memset(static_cast<void *>(first + begin), 0, (end - begin) * sizeof(T));
+                    } else {
+                        for (std::size_t i = begin; i < end; i++) {
+                            alloc_traits::construct(_allocator, first + i);
+                        }
+                    }
+                });
+                _size = new_size;
+                return;
+            }
+        }
+        construct_tail(new_size);
+    }
+
+    /// Default-initializes the values of rank _size to new_size - 1, which
+    /// leaves the storage of trivially default constructible values untouched.
+    /// Other values go through Allocator::construct if it is provided.
+    void default_construct_tail(std::size_t new_size) {
+        if constexpr (std::is_trivially_default_constructible_v<T>) {
+            if (new_size > _size)
+                _size = new_size;
+        } else {
+            for (; _size < new_size; _size++) {
+                if constexpr (requires(Allocator &a, T *p) { a.construct(p); })
+                    alloc_traits::construct(_allocator, _data + _size);
+                else
+                    ::new (static_cast<void *>(_data + _size)) T;
+            }
+        }
+    }
+
+    /// Destroys[1] the values of rank new_size to _size - 1, which is a no-op
+    /// for trivially destructible values.
+    void destroy_tail(std::size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; _size > new_size; _size--) {
+                alloc_traits::destroy(_allocator, _data + _size - 1);
+            }
+        }
+        if (new_size < _size)
+            _size = new_size;
+    }
+
+    /// Takes ownership of the buffer of other, leaving it empty.
+    /// The current buffer must have been released beforehand.
+    void steal(vector_t &other) noexcept {
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = nullptr;
+        other._size = 0;
+        other._capacity = 0;
+    }
+
+    /// Allocates a buffer for exactly n values.
+    T *allocate(std::size_t n) {
+        T *p = alloc_traits::allocate(_allocator, n);
+        vector_stats_on_allocate<vector_t>(n * sizeof(T));
+        return p;
+    }
+
+    /// Allocates a buffer for at least n values, and returns it along with
+    /// the number of values it can actually hold, which becomes the capacity.
+    allocation_result_t<T> allocate_at_least(std::size_t n) {
+        if constexpr (has_allocate_at_least_v<Allocator, T>) {
+            auto const result = _allocator.allocate_at_least(n);
+            vector_stats_on_allocate<vector_t>(result.count * sizeof(T));
+            return {result.ptr, result.count};
+        } else {
+            return {allocate(n), n};
+        }
+    }
+
+    /// Deallocates a buffer of n values.
+    void deallocate(T *p, std::size_t n) noexcept {
+        alloc_traits::deallocate(_allocator, p, n);
+        vector_stats_on_deallocate<vector_t>();
+    }
+
+    /// Relocation engine: moves the live values to a buffer that can hold at
+    /// least new_capacity values, and releases the old one. This is the only
+    /// place where reserve(), resize() and emplace_back() change buffers.
+    /// - Trivially relocatable values are moved with a single memcpy, and
+    /// their old copies are not destroyed,
+    /// - if the allocator can also resize a buffer in place (see
+    /// has_reallocate), the copy is left to the allocator entirely,
+    /// - other values are moved one by one, then destroyed[1].
+    /// If the allocator tells how much room it actually handed out (see
+    /// has_allocate_at_least), all of it is used as capacity.
+    /// Resizing a buffer in place counts as one allocation and one
+    /// deallocation in the statistics.
+    void relocate(std::size_t new_capacity) {
+        vector_stats_on_relocate<vector_t>(_size, new_capacity);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if constexpr (has_reallocate_at_least_v<Allocator, T>) {
+                if (_data) {
+                    auto const result = _allocator.reallocate_at_least(_data, _capacity, new_capacity);
+                    vector_stats_on_deallocate<vector_t>();
+                    vector_stats_on_allocate<vector_t>(result.count * sizeof(T));
+                    _data = result.ptr;
+                    _capacity = result.count;
+                    return;
+                }
+            } else if constexpr (has_reallocate_v<Allocator, T>) {
+                if (_data) {
+                    _data = _allocator.reallocate(_data, _capacity, new_capacity);
+                    vector_stats_on_deallocate<vector_t>();
+                    vector_stats_on_allocate<vector_t>(new_capacity * sizeof(T));
+                    _capacity = new_capacity;
+                    return;
+                }
+            }
+            auto const [new_buffer, count] = allocate_at_least(new_capacity);
+            if (_size)
+                std::memcpy(static_cast<void *>(new_buffer),
+                            static_cast<void const *>(_data), _size * sizeof(T));
+            if (_data)
+                deallocate(_data, _capacity);
+            _data = new_buffer;
+            _capacity = count;
+        } else {
+            //allocate enough space for the new capacity and moving values from the old buffer
+            auto const [new_buffer, count] = allocate_at_least(new_capacity);
+            for (std::size_t i = 0; i < _size; i++) {
+                alloc_traits::construct(_allocator, new_buffer + i, std::move(_data[i]));
+            }
+            //destroying and deallocating old values
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (std::size_t i = 0; i < _size; i++) {
+                    alloc_traits::destroy(_allocator, _data + i);
+                }
+            }
+            if (_data)
+                deallocate(_data, _capacity);
+            _data = new_buffer;
+            _capacity = count;
+        }
+    }
 
 public:
     /// Default constructor that initializes an empty vector with no capacity
-    vector_t() noexcept: _data(nullptr), _size(0), _capacity(0) {}
+    vector_t() noexcept(noexcept(Allocator()))
+        : _data(nullptr), _size(0), _capacity(0), _allocator() {}
+
+    /// Initializes an empty vector with no capacity that will draw its memory
+    /// from alloc.
+    explicit vector_t(Allocator const &alloc) noexcept
+        : _data(nullptr), _size(0), _capacity(0), _allocator(alloc) {}
 
     /// The following constructor should initialize a vector of given size. The
     /// capacity should be the same as the size, and all the elements must be
     /// default constructed[1].
-
-    // Calling the default constructor first to ensure the vector
-    // is well initialized. Member functions such as resize or reserve
-    // should never be used on uninitialized objects.
-    explicit vector_t(std::size_t s) : _size(s), _capacity(s) {
+    explicit vector_t(std::size_t s, Allocator const &alloc = Allocator())
+        : _data(nullptr), _size(0), _capacity(s), _allocator(alloc) {
         //allocating memory
-        _data = _allocator.allocate(s);
+        _data = allocate(s);
         //default constructing
-        for (std::size_t i = 0; i < _size; i++) {
-            std::construct_at(_data + i);
-        }
+        construct_tail(s);
+    }
+
+    /// Same as above, except that values are default-initialized instead of
+    /// value-initialized: trivial values are left uninitialized, and must be
+    /// written before being read.
+    vector_t(std::size_t s, default_init_t, Allocator const &alloc = Allocator())
+        : _data(nullptr), _size(0), _capacity(s), _allocator(alloc) {
+        _data = allocate(s);
+        default_construct_tail(s);
+    }
+
+    /// Same as above, except that values are value-initialized in parallel
+    /// slices by init (see parallel_init_t).
+    template<typename Splitter>
+    vector_t(std::size_t s, parallel_init_t<Splitter> const &init,
+             Allocator const &alloc = Allocator())
+        : _data(nullptr), _size(0), _capacity(s), _allocator(alloc) {
+        _data = allocate(s);
+        construct_tail(s, init);
     }
 
     //copy constructor
-    vector_t(vector_t const &other) : _size(other._size), _capacity(other._capacity) {
-        _data = _allocator.allocate(other._capacity);
-        for (std::size_t i = 0; i < _size; i++) {
-            std::construct_at(_data + i, *(other._data + i));
+    vector_t(vector_t const &other)
+        : vector_t(other, alloc_traits::select_on_container_copy_construction(
+                              other._allocator)) {}
+
+    //allocator-extended copy constructor
+    vector_t(vector_t const &other, Allocator const &alloc)
+        : _data(nullptr), _size(0), _capacity(other._capacity), _allocator(alloc) {
+        _data = allocate(_capacity);
+        for (; _size < other._size; _size++) {
+            alloc_traits::construct(_allocator, _data + _size, other._data[_size]);
         }
     }
 
     //move constructor
-    vector_t(vector_t &&other) noexcept: _size(other._size), _capacity(other._capacity) {
-        _data = _allocator.allocate(_capacity);
-        _data = other._data;
-        other._data = nullptr;
-        other._size = 0;
+    vector_t(vector_t &&other) noexcept
+        : _data(nullptr), _size(0), _capacity(0), _allocator(std::move(other._allocator)) {
+        steal(other);
+    }
+
+    //allocator-extended move constructor: the buffer can only be stolen when
+    //both allocators are interchangeable, otherwise values are moved one by one
+    vector_t(vector_t &&other, Allocator const &alloc)
+        : _data(nullptr), _size(0), _capacity(0), _allocator(alloc) {
+        if (alloc_traits::is_always_equal::value || _allocator == other._allocator) {
+            steal(other);
+            return;
+        }
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            alloc_traits::construct(_allocator, _data + _size, std::move(other._data[_size]));
+        }
     }
 
-    //copy assignment operator
+    //copy assignment operator: the current buffer is reused if it is large
+    //enough, in which case values are assigned over the live ones, and only
+    //the remaining ones are copy constructed
     vector_t &operator=(vector_t const &other) {
-        //copy the size and the capacity of the rhs variable
-        _size = other._size;
-        _capacity = other._capacity;
-        //allocate memory using the size the rhs variable
-        _data = _allocator.allocate(_capacity);
-        //copy constructing values
-        for (std::size_t i = 0; i < _size; i++) {
-            std::construct_at(_data + i, *(other._data + i));
+        if (this == &other)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            //the current buffer belongs to the old allocator
+            if (!alloc_traits::is_always_equal::value && _allocator != other._allocator)
+                release();
+            _allocator = other._allocator;
+        }
+        if (other._size > _capacity) {
+            //allocate a new buffer, in which every value is copy constructed
+            release();
+            auto const [new_buffer, count] = allocate_at_least(other._size);
+            _data = new_buffer;
+            _capacity = count;
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (other._size)
+                std::memcpy(static_cast<void *>(_data),
+                            static_cast<void const *>(other._data), other._size * sizeof(T));
+            _size = other._size;
+        } else {
+            //copy assigning over live values
+            for (std::size_t i = 0; i < _size && i < other._size; i++) {
+                _data[i] = other._data[i];
+            }
+            //copy constructing the others
+            for (; _size < other._size; _size++) {
+                alloc_traits::construct(_allocator, _data + _size, other._data[_size]);
+            }
+            destroy_tail(other._size);
         }
         return *this;
     }
 
     //Move assignment operator
-    vector_t &operator=(vector_t &&other) noexcept {
-        _size = other.size();
-        _capacity = other._capacity;
-        _data = _allocator.allocate(_capacity);
+    vector_t &operator=(vector_t &&other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) {
+        if (this == &other)
+            return *this;
+        release();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            _allocator = std::move(other._allocator);
+        } else if (!alloc_traits::is_always_equal::value &&
+                   _allocator != other._allocator) {
+            //the rhs buffer cannot be handed over to our allocator,
+            //so values are moved one by one into a buffer of our own
+            reserve(other._size);
+            for (; _size < other._size; _size++) {
+                alloc_traits::construct(_allocator, _data + _size, std::move(other._data[_size]));
+            }
+            return *this;
+        }
         //Point the _data to the rhs buffer
-        _data = other._data;
-        other._data = nullptr;
-        //put the size at 0 to not have invalid state
-        other._size = 0;
+        steal(other);
         return *this;
     }
 
+    /// Exchanges the contents of two vectors. Allocators are only swapped if
+    /// they propagate on swap, otherwise they must compare equal.
+    void swap(vector_t &other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            swap(_allocator, other._allocator);
+        }
+        swap(_data, other._data);
+        swap(_size, other._size);
+        swap(_capacity, other._capacity);
+    }
+
+    friend void swap(vector_t &a, vector_t &b) noexcept { a.swap(b); }
+
+    /// Returns a copy of the allocator.
+    Allocator get_allocator() const noexcept { return _allocator; }
+
+    /// Returns a pointer to the buffer, aligned on alignment, or nullptr.
+    T *data() { return std::assume_aligned<alignment>(_data); }
+
+    /// Returns a constant pointer to the buffer, aligned on alignment, or
+    /// nullptr.
+    T const *data() const { return std::assume_aligned<alignment>(_data); }
+
     /// Returns a pointer as an iterator to the beginning of the vector.
-    T *begin() { return _data; }
+    T *begin() { return data(); }
 
     /// Returns a pointer as an iterator to the end of the vector.
     T *end() { return _data + _size; }
 
     /// Returns a constant pointer as an iterator to the beginning of the vector.
-    T const *begin() const { return _data; }
+    T const *begin() const { return data(); }
 
     /// Returns a constant pointer as an iterator to the end of the vector.
     T const *end() const { return _data + _size; }
@@ -225,6 +719,9 @@ public:
     /// Returns the size of the vector.
     std::size_t size() const { return _size; }
 
+    /// Returns the capacity of the memory buffer.
+    std::size_t capacity() const { return _capacity; }
+
     /// Non-const element access for getting and modifying elements.
     T &operator[](std::size_t i) { return _data[i]; }
 
@@ -234,22 +731,20 @@ public:
     /// emplace_back constructs a new element at the end of the vector.
     /// The arguments are expanded and forwarded to std::construct_at just after
     /// the pointer parameter (https://en.cppreference.com/w/cpp/utility/forward).
-    /// If the capacity is zero, you must reserve enough memory for 16 elements.
-    /// Otherwise, if the capacity is insufficient, you must reserve double the
-    /// current capacity to avoid allocating memory too frequently.
+    /// If the capacity is insufficient, the growth policy decides of the new
+    /// capacity. By default, enough memory for 16 elements is reserved when the
+    /// capacity is zero, and the capacity is doubled otherwise to avoid
+    /// allocating memory too frequently.
     /// NB: emplace_back can be used to move/copy elements to the vector just like
     /// push_back.
 
     template<typename... Args>
     void emplace_back(Args &&...args) {
-        //reserving twice the capacity if we filled the whole buffer
+        //asking the growth policy for more room if we filled the whole buffer
         if (_size == _capacity)
-            reserve(2 * _capacity);
-        //default reserve 16 for empty vectors
-        if (_capacity == 0)
-            reserve(16);
+            reserve(GrowthPolicy::template next_capacity<T>(_capacity));
         //putting values at the end of the buffer
-        std::construct_at(end(), std::forward<Args>(args)...);
+        alloc_traits::construct(_allocator, end(), std::forward<Args>(args)...);
         _size++;
     }
 
@@ -265,25 +760,14 @@ public:
     /// - therefore you are expected to allocate a new buffer, move the values to
     /// that new buffer, and then destroy[1] the values from the old buffer before
     /// deallocating it (values that have been moved should be destroyed too).
+    /// The transfer itself is done by relocate(), which skips the moves and
+    /// destructions for trivially relocatable values.
 
     void reserve(std::size_t new_capacity) {
-        if (new_capacity < _size) {
-            //resizing the vector if the new size is smaller than the new capacity
-            resize(_size);
-            _capacity = _size;
-            return;
-        }
+        //new_capacity < _size <= _capacity: the buffer is already big enough,
+        //and the allocator must be given back the exact capacity it handed out
         if (new_capacity > _capacity) {
-            //allocate enough space for the new capacity and moving values from the old buffer
-            T *new_buffer = _allocator.allocate(new_capacity);
-            for (std::size_t i = 0; i < _size; i++) {
-                std::construct_at(new_buffer + i, std::move(_data[i]));
-            }
-            //destroying and deallocating old values
-            std::destroy(begin(), end());
-            _allocator.deallocate(_data, _capacity);
-            _data = new_buffer;
-            _capacity = new_capacity;
+            relocate(new_capacity);
         }
     }
 
@@ -297,26 +781,49 @@ public:
                 reserve(new_size);
             }
             //default constructing values
-            for (std::size_t i = _size; i < new_size; i++) {
-                std::construct_at(_data + i);
-            }
+            construct_tail(new_size);
         }
-        if (new_size < _size) {
-            //if new size is smaller than the previous size we destroy old data
-            std::destroy_n(_data + new_size, _size - new_size);
-        }
-        _size = new_size;
+        //if new size is smaller than the previous size we destroy old data
+        destroy_tail(new_size);
+    }
+
+    /// Same as resize(), except that new values are value-initialized in
+    /// parallel slices by init (see parallel_init_t).
+    template<typename Splitter>
+    void resize(std::size_t new_size, parallel_init_t<Splitter> const &init) {
+        if (new_size > _capacity)
+            reserve(new_size);
+        construct_tail(new_size, init);
+        destroy_tail(new_size);
+    }
+
+    /// Same as resize(), except that new values are default-initialized
+    /// instead of value-initialized: trivial values are left uninitialized,
+    /// and must be written before being read.
+    void resize_for_overwrite(std::size_t new_size) {
+        if (new_size > _capacity)
+            reserve(new_size);
+        default_construct_tail(new_size);
+        destroy_tail(new_size);
     }
 
     /// The destructor should destroy[1] all the values that are alive and
     /// deallocate the memory buffer, if there is one.
-    ~vector_t() {
-        //checking if the pointer is not null
-        if (_data) {
-            //destroying and deallocating the memory buffer
-            std::destroy_n(_data, _size);
-            _allocator.deallocate(_data, _capacity);
-            _data = nullptr;
-        }
-    }
+    ~vector_t() { release(); }
 };
+
+/// vector_t on buffers aligned on Alignment bytes, a cache line by default
+/// (see aligned_allocator.hpp).
+template<typename T, std::size_t Alignment = 64>
+using aligned_vector_t = vector_t<T, aligned_allocator_t<T, Alignment>>;
+
+namespace pmr {
+
+/// vector_t drawing its memory from a std::pmr::memory_resource, such as a
+/// std::pmr::monotonic_buffer_resource for short-lived scratch vectors that
+/// are all released at once. Like std::pmr containers, nested pmr::vector_t
+/// values pick up the memory resource of the vector holding them.
+template<typename T>
+using vector_t = ::vector_t<T, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
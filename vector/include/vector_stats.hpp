@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// vector_t statistics ---------------------------------------------------------
+
+// Building with VECTOR_T_STATS defined enables an instrumentation layer that
+// counts, for each vector_t type:
+// - allocations, deallocations and allocated bytes,
+// - relocations (ie. buffer changes in reserve(), resize() and emplace_back())
+// and the number of values they moved,
+// - a histogram of the capacities requested by relocations, by power of two,
+// which tells where a well-placed reserve() would help.
+
+// vector_stats<Vector>() returns a snapshot of the statistics of a vector
+// type, and dump_vector_stats() prints those of every vector type that was
+// used so far. Calling dump_vector_stats_at_exit() once registers the dump to
+// run when the process exits.
+
+// Without VECTOR_T_STATS, the hooks called by vector_t are empty constexpr
+// functions: they compile to nothing, and the rest of this header does not
+// exist. The macro must have the same value in every translation unit of a
+// program.
+
+/// Statistics of a vector type at a given time.
+struct vector_stats_snapshot_t {
+    /// Number of histogram buckets: bucket i counts the relocations to a
+    /// capacity in [2^i, 2^(i+1)).
+    static constexpr std::size_t bucket_count = 64;
+
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes_allocated = 0;
+    std::uint64_t relocations = 0;
+    std::uint64_t elements_moved = 0;
+    std::uint64_t growth_histogram[bucket_count] = {};
+};
+
+#if defined(VECTOR_T_STATS)
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+inline constexpr bool vector_stats_enabled = true;
+
+namespace vector_stats_detail {
+
+/// Live statistics of a vector type, updated concurrently.
+struct counters_t {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> deallocations{0};
+    std::atomic<std::uint64_t> bytes_allocated{0};
+    std::atomic<std::uint64_t> relocations{0};
+    std::atomic<std::uint64_t> elements_moved{0};
+    std::atomic<std::uint64_t> growth_histogram[vector_stats_snapshot_t::bucket_count] = {};
+
+    /// Printable name of the vector type.
+    std::string name;
+
+    /// Next vector type in the registry.
+    counters_t *next = nullptr;
+
+    vector_stats_snapshot_t snapshot() const {
+        vector_stats_snapshot_t result;
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        result.deallocations = deallocations.load(std::memory_order_relaxed);
+        result.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        result.relocations = relocations.load(std::memory_order_relaxed);
+        result.elements_moved = elements_moved.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < vector_stats_snapshot_t::bucket_count; i++) {
+            result.growth_histogram[i] = growth_histogram[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+};
+
+/// Registry of every vector type that was used, as a linked list.
+struct registry_t {
+    std::mutex mutex;
+    counters_t *first = nullptr;
+};
+
+inline registry_t &registry() {
+    static registry_t instance;
+    return instance;
+}
+
+inline std::string demangle(char const *name) {
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void *)> demangled(
+        abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+    if (status == 0)
+        return demangled.get();
+#endif
+    return name;
+}
+
+/// Returns the statistics of a vector type, registering it on first use.
+template<typename Vector>
+counters_t &counters() {
+    static counters_t *const instance = [] {
+        auto *c = new counters_t;
+        c->name = demangle(typeid(Vector).name());
+        registry_t &r = registry();
+        std::lock_guard lock(r.mutex);
+        c->next = r.first;
+        r.first = c;
+        return c;
+    }();
+    return *instance;
+}
+
+} // namespace vector_stats_detail
+
+/// Returns a snapshot of the statistics of a vector type.
+template<typename Vector>
+vector_stats_snapshot_t vector_stats() {
+    return vector_stats_detail::counters<Vector>().snapshot();
+}
+
+/// Prints the statistics of every vector type that was used so far.
+inline void dump_vector_stats(std::ostream &out = std::cerr) {
+    vector_stats_detail::registry_t &r = vector_stats_detail::registry();
+    std::lock_guard lock(r.mutex);
+    for (auto const *c = r.first; c; c = c->next) {
+        vector_stats_snapshot_t const s = c->snapshot();
+        out << c->name << ":\n"
+            << "  allocations: " << s.allocations << ", deallocations: " << s.deallocations
+            << ", bytes allocated: " << s.bytes_allocated << '\n'
+            << "  relocations: " << s.relocations << ", elements moved: " << s.elements_moved
+            << '\n';
+        for (std::size_t i = 0; i < vector_stats_snapshot_t::bucket_count; i++) {
+            if (s.growth_histogram[i])
+                out << "  capacity in [2^" << i << ", 2^" << i + 1
+                    << "): " << s.growth_histogram[i] << '\n';
+        }
+    }
+}
+
+/// Registers dump_vector_stats() to run at process exit. Calling it more
+/// than once has no effect.
+inline void dump_vector_stats_at_exit() {
+    static bool const registered = [] {
+        std::atexit([] { dump_vector_stats(); });
+        return true;
+    }();
+    static_cast<void>(registered);
+}
+
+// Hooks called by vector_t
+
+template<typename Vector>
+void vector_stats_on_allocate(std::size_t bytes) {
+    auto &c = vector_stats_detail::counters<Vector>();
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+template<typename Vector>
+void vector_stats_on_deallocate() {
+    vector_stats_detail::counters<Vector>().deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename Vector>
+void vector_stats_on_relocate(std::size_t moved, std::size_t new_capacity) {
+    auto &c = vector_stats_detail::counters<Vector>();
+    c.relocations.fetch_add(1, std::memory_order_relaxed);
+    c.elements_moved.fetch_add(moved, std::memory_order_relaxed);
+    std::size_t const bucket = new_capacity ? std::size_t(std::bit_width(new_capacity)) - 1 : 0;
+    c.growth_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+#else
+
+inline constexpr bool vector_stats_enabled = false;
+
+// Hooks called by vector_t
+
+template<typename Vector>
+constexpr void vector_stats_on_allocate(std::size_t) noexcept {}
+
+template<typename Vector>
+constexpr void vector_stats_on_deallocate() noexcept {}
+
+template<typename Vector>
+constexpr void vector_stats_on_relocate(std::size_t, std::size_t) noexcept {}
+
+#endif
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if !defined(__linux__)
+#error "vm_vector_t relies on Linux virtual memory management"
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vector.hpp"
+
+// vm_vector_t -----------------------------------------------------------------
+
+// vm_vector_t<T> is a vector whose values never move: it reserves a large
+// range of virtual addresses up front (64 GiB by default), which is
+// inaccessible (PROT_NONE) and therefore costs no memory, then commits pages
+// on demand as the vector grows. Growing never copies anything, and pointers
+// to values stay valid for the whole lifetime of the vector, which makes it
+// suitable for append-only tables handing out raw pointers.
+
+// It follows the invariants and lifetime rules of vector_t (see vector.hpp),
+// except that:
+// - _capacity is the number of values that fit in the committed pages,
+// - the capacity can grow up to max_capacity(), beyond which std::bad_alloc
+// is thrown,
+// - decommit() gives the pages past the live values back to the OS, with
+// madvise(MADV_DONTNEED).
+
+// The size of the reserved range is passed to the constructors as a
+// vm_reservation_t, so that vm_vector_t(n) constructs n values like
+// vector_t(n).
+
+// Pages are committed with mprotect(PROT_READ | PROT_WRITE), at least
+// min_commit bytes at a time, and the committed size at least doubles every
+// time to keep the number of system calls logarithmic. Physical memory is
+// only used once pages are touched.
+
+/// Size of the virtual address range reserved by a vm_vector_t, in bytes.
+struct vm_reservation_t {
+    std::size_t bytes;
+};
+
+template<typename T>
+struct vm_vector_t {
+public:
+    using value_type = T;
+
+    /// Size of the virtual address range reserved by default.
+    static constexpr std::size_t default_reservation = std::size_t(64) << 30;
+
+    /// Minimum number of bytes committed at once.
+    static constexpr std::size_t min_commit = std::size_t(64) << 10;
+
+private:
+    /// Start of the reserved range, or nullptr for moved-from vectors, which
+    /// reserve a new range of default_reservation bytes when they grow again.
+    T *_data;
+
+    /// Size of the vector.
+    /// Holds the number of alive values.
+    std::size_t _size;
+
+    /// Number of values that fit in the committed pages.
+    std::size_t _capacity;
+
+    /// Size of the reserved range, in bytes. Always a multiple of the page
+    /// size.
+    std::size_t _reserved;
+
+    /// Size of the committed pages, in bytes. Always a multiple of the page
+    /// size.
+    std::size_t _committed;
+
+    static std::size_t page_size() noexcept { return std::size_t(sysconf(_SC_PAGESIZE)); }
+
+    static std::size_t round_to_pages(std::size_t bytes) noexcept {
+        std::size_t const page = page_size();
+        return (bytes + page - 1) / page * page;
+    }
+
+    /// Reserves max_bytes of inaccessible virtual addresses.
+    void reserve_range(std::size_t max_bytes) {
+        _reserved = round_to_pages(max_bytes < sizeof(T) ? sizeof(T) : max_bytes);
+        void *p = mmap(nullptr, _reserved, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        _data = static_cast<T *>(p);
+    }
+
+    /// Makes the pages holding the first bytes of the range accessible.
+    void commit(std::size_t bytes) {
+        if (bytes <= _committed)
+            return;
+        if (bytes > _reserved)
+            throw std::bad_alloc();
+        std::size_t new_committed = round_to_pages(bytes);
+        if (new_committed < 2 * _committed)
+            new_committed = 2 * _committed;
+        if (new_committed < min_commit)
+            new_committed = min_commit;
+        if (new_committed > _reserved)
+            new_committed = _reserved;
+        if (mprotect(reinterpret_cast<std::byte *>(_data) + _committed,
+                     new_committed - _committed, PROT_READ | PROT_WRITE) != 0)
+            throw std::bad_alloc();
+        _committed = new_committed;
+        _capacity = _committed / sizeof(T);
+    }
+
+    /// Destroys[1] the values of rank new_size to _size - 1.
+    void destroy_tail(std::size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; _size > new_size; _size--) {
+                std::destroy_at(_data + _size - 1);
+            }
+        }
+        if (new_size < _size)
+            _size = new_size;
+    }
+
+    /// Destroys the values and unmaps the whole range.
+    void release() noexcept {
+        if (_data) {
+            destroy_tail(0);
+            munmap(static_cast<void *>(_data), _reserved);
+        }
+        _data = nullptr;
+        _size = 0;
+        _capacity = 0;
+        _reserved = 0;
+        _committed = 0;
+    }
+
+    /// Takes the range of other, leaving it empty with no range at all.
+    void steal(vm_vector_t &other) noexcept {
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _capacity = std::exchange(other._capacity, 0);
+        _reserved = std::exchange(other._reserved, 0);
+        _committed = std::exchange(other._committed, 0);
+    }
+
+public:
+    /// Initializes an empty vector, reserving default_reservation bytes of
+    /// virtual addresses without committing any page.
+    vm_vector_t() : vm_vector_t(vm_reservation_t{default_reservation}) {}
+
+    /// Initializes an empty vector, reserving reservation.bytes of virtual
+    /// addresses without committing any page.
+    explicit vm_vector_t(vm_reservation_t reservation)
+        : _data(nullptr), _size(0), _capacity(0), _reserved(0), _committed(0) {
+        reserve_range(reservation.bytes);
+    }
+
+    /// Initializes a vector of s value-initialized values, in a range of
+    /// reservation.bytes of virtual addresses.
+    explicit vm_vector_t(std::size_t s,
+                         vm_reservation_t reservation = vm_reservation_t{default_reservation})
+        : vm_vector_t(reservation) {
+        resize(s);
+    }
+
+    //copy constructor: the copy reserves as much virtual memory as other
+    vm_vector_t(vm_vector_t const &other) : vm_vector_t(vm_reservation_t{other._reserved}) {
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            std::construct_at(_data + _size, other._data[_size]);
+        }
+    }
+
+    //move constructor: the range is handed over, so pointers to the values
+    //stay valid
+    vm_vector_t(vm_vector_t &&other) noexcept
+        : _data(nullptr), _size(0), _capacity(0), _reserved(0), _committed(0) {
+        steal(other);
+    }
+
+    //copy assignment operator: the current range is kept if the values of
+    //other fit in it, otherwise it is replaced by one as large as the range
+    //of other, like for a copy construction
+    vm_vector_t &operator=(vm_vector_t const &other) {
+        if (this == &other)
+            return *this;
+        destroy_tail(0);
+        if (other._size > max_capacity()) {
+            release();
+            reserve_range(other._reserved);
+        }
+        reserve(other._size);
+        for (; _size < other._size; _size++) {
+            std::construct_at(_data + _size, other._data[_size]);
+        }
+        return *this;
+    }
+
+    //Move assignment operator
+    vm_vector_t &operator=(vm_vector_t &&other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    /// Returns a pointer as an iterator to the beginning of the vector.
+    T *begin() { return _data; }
+
+    /// Returns a pointer as an iterator to the end of the vector.
+    T *end() { return _data + _size; }
+
+    /// Returns a constant pointer as an iterator to the beginning of the vector.
+    T const *begin() const { return _data; }
+
+    /// Returns a constant pointer as an iterator to the end of the vector.
+    T const *end() const { return _data + _size; }
+
+    /// Returns the size of the vector.
+    std::size_t size() const { return _size; }
+
+    /// Returns the number of values that fit in the committed pages.
+    std::size_t capacity() const { return _capacity; }
+
+    /// Returns the number of values that fit in the reserved range.
+    std::size_t max_capacity() const { return _reserved / sizeof(T); }
+
+    /// Non-const element access for getting and modifying elements.
+    T &operator[](std::size_t i) { return _data[i]; }
+
+    /// Read-only element access.
+    T const &operator[](std::size_t i) const { return _data[i]; }
+
+    /// Constructs a new element at the end of the vector, committing more
+    /// pages if needed. Values never move.
+    /// Throws std::bad_alloc if the reserved range is full.
+    template<typename... Args>
+    T &emplace_back(Args &&...args) {
+        if (_size == _capacity)
+            reserve(_size + 1);
+        T *value = std::construct_at(_data + _size, std::forward<Args>(args)...);
+        _size++;
+        return *value;
+    }
+
+    /// Commits enough pages for new_capacity values.
+    /// Throws std::bad_alloc if new_capacity exceeds max_capacity().
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > _capacity) {
+            if (!_data)
+                reserve_range(default_reservation);
+            if (new_capacity > max_capacity())
+                throw std::bad_alloc();
+            commit(new_capacity * sizeof(T));
+        }
+    }
+
+    /// Sets the size of the vector, destroying or value-initializing values as
+    /// necessary, and committing pages as needed. Zero initializable values
+    /// (see vector.hpp) are value-initialized with a single memset.
+    void resize(std::size_t new_size) {
+        reserve(new_size);
+        if constexpr (is_zero_initializable_v<T>) {
+            if (new_size > _size) {
+                std::memset(static_cast<void *>(_data + _size), 0,
+                            (new_size - _size) * sizeof(T));
+                _size = new_size;
+            }
+        } else {
+            for (; _size < new_size; _size++) {
+                std::construct_at(_data + _size);
+            }
+        }
+        destroy_tail(new_size);
+    }
+
+    /// Gives the committed pages past the live values back to the OS, and
+    /// makes them inaccessible again. The addresses stay reserved, and
+    /// pointers to live values stay valid.
+    void decommit() noexcept {
+        if (!_data)
+            return;
+        std::size_t const keep = round_to_pages(_size * sizeof(T));
+        if (keep < _committed) {
+            std::byte *first = reinterpret_cast<std::byte *>(_data) + keep;
+            madvise(first, _committed - keep, MADV_DONTNEED);
+            mprotect(first, _committed - keep, PROT_NONE);
+            _committed = keep;
+            _capacity = _committed / sizeof(T);
+        }
+    }
+
+    /// Same as decommit().
+    void shrink_to_fit() noexcept { decommit(); }
+
+    /// Destroys the values and releases the whole range.
+    ~vm_vector_t() { release(); }
+};
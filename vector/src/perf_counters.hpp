@@ -0,0 +1,181 @@
+#pragma once
+
+/// Hardware performance counters for the benchmarks.
+
+// perf_counters_t opens a group of counters with Linux perf_event_open, which
+// are started and stopped together around the code being measured. Counters
+// that cannot be opened, because of insufficient permissions
+// (/proc/sys/kernel/perf_event_paranoid), missing hardware support (eg. in virtual
+// machines) or another OS, are skipped: in the worst case, only the wall-clock
+// time is reported.
+
+// Only user-space events are counted, which is what perf_event_paranoid <= 2
+// allows for unprivileged processes. They are counted on the calling thread
+// and on the threads it starts while the counters are open, but not on
+// threads started before, like the workers of a thread_pool_t: for the
+// parallel algorithms, the figures only cover the share of the caller.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct perf_counters_t {
+    /// Events that are counted, when available.
+    enum event_t { cycles, instructions, l1d_misses, llc_misses, branch_misses, page_faults, event_count };
+
+    /// Printable names of the events.
+    static constexpr char const *event_names[event_count] = {
+        "cycles", "instructions", "L1d misses", "LLC misses", "branch misses", "page faults"};
+
+private:
+    /// File descriptors of the counters, -1 for unavailable ones.
+    int _fds[event_count];
+
+    /// File descriptor of the group leader, -1 if no counter is available.
+    int _leader = -1;
+
+    /// Counter values of the last measurement.
+    std::uint64_t _values[event_count] = {};
+
+    /// Wall-clock time of the last measurement.
+    std::chrono::nanoseconds _elapsed{0};
+
+    std::chrono::steady_clock::time_point _start;
+
+    /// Makes the compiler assume that the memory at p is read and written,
+    /// so that computing it cannot be optimized away.
+    static void escape(void const *p) noexcept {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(p) : "memory");
+#else
+        //weaker: only the address is kept, the values may still be elided
+        static void const *volatile sink;
+        sink = p;
+#endif
+    }
+
+#if defined(__linux__)
+    static int open_counter(std::uint32_t type, std::uint64_t config, int group_fd) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = group_fd == -1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+    static constexpr std::uint64_t cache_miss(std::uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+public:
+    /// Opens every available counter.
+    perf_counters_t() {
+        for (int &fd : _fds) {
+            fd = -1;
+        }
+#if defined(__linux__)
+        struct {
+            std::uint32_t type;
+            std::uint64_t config;
+        } const events[event_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+        for (int i = 0; i < event_count; i++) {
+            _fds[i] = open_counter(events[i].type, events[i].config, _leader);
+            if (_fds[i] != -1 && _leader == -1)
+                _leader = _fds[i];
+        }
+#endif
+    }
+
+    perf_counters_t(perf_counters_t const &) = delete;
+    perf_counters_t &operator=(perf_counters_t const &) = delete;
+
+    /// Closes the counters.
+    ~perf_counters_t() {
+#if defined(__linux__)
+        for (int fd : _fds) {
+            if (fd != -1)
+                close(fd);
+        }
+#endif
+    }
+
+    /// Tells whether a given event is counted.
+    bool available(event_t event) const { return _fds[event] != -1; }
+
+    /// Resets and starts the counters.
+    void start() {
+#if defined(__linux__)
+        if (_leader != -1) {
+            ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        _start = std::chrono::steady_clock::now();
+    }
+
+    /// Stops the counters and records their values.
+    void stop() {
+        _elapsed = std::chrono::steady_clock::now() - _start;
+#if defined(__linux__)
+        if (_leader != -1)
+            ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int i = 0; i < event_count; i++) {
+            if (_fds[i] == -1 || read(_fds[i], &_values[i], sizeof(_values[i])) != sizeof(_values[i]))
+                _values[i] = 0;
+        }
+#endif
+    }
+
+    /// Value of a counter during the last measurement.
+    std::uint64_t value(event_t event) const { return _values[event]; }
+
+    /// Wall-clock time of the last measurement.
+    std::chrono::nanoseconds elapsed() const { return _elapsed; }
+
+    /// Prints the last measurement divided by a number of operations.
+    void print(std::string const &name, std::size_t ops, std::ostream &out = std::cout) const {
+        double const per_op = 1. / double(ops ? ops : 1);
+        out << name << ", per operation: " << std::setprecision(4)
+            << double(_elapsed.count()) * per_op << " ns";
+        for (int i = 0; i < event_count; i++) {
+            if (_fds[i] != -1)
+                out << ", " << double(_values[i]) * per_op << ' ' << event_names[i];
+        }
+        out << '\n';
+    }
+
+    /// Runs fn once under the counters, and prints the results divided by
+    /// ops, the number of operations fn performs.
+    template<typename Fn>
+    static void report(std::string const &name, std::size_t ops, Fn &&fn) {
+        perf_counters_t counters;
+        counters.start();
+        auto const result = fn();
+        escape(&result);
+        counters.stop();
+        counters.print(name, ops);
+    }
+};
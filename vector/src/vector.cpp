@@ -3,14 +3,45 @@
 // When your implementation is done, all the tests should pass.
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
 #include <numeric>
-
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include "aligned_allocator.hpp"
+#include "aosoa_vector.hpp"
+#include "concurrent_vector.hpp"
+#include "cpu_dispatch.hpp"
+#include "inplace_vector.hpp"
+#include "malloc_allocator.hpp"
+#include "parallel.hpp"
+#include "segmented_vector.hpp"
+#include "simd.hpp"
+#include "small_vector.hpp"
+#include "soa_vector.hpp"
+#include "spmc_vector.hpp"
 #include "vector.hpp"
 
+#if defined(__linux__)
+#include "mmap_allocator.hpp"
+#include "vm_vector.hpp"
+#endif
+
 /// Series of tests on values whose constructors and destructors are trivial
 /// (ie. don't perform any action)
 TEST_CASE("Basic functional tests: trivial values") {
@@ -419,3 +450,2006 @@ TEST_CASE("Lifetime management and copy/move semantics") {
     CHECK(lt::destruction == 64);
     lt::zero();
 }
+
+namespace al {
+
+/// Number of live allocations, all tracking_allocator_t instances included
+static long live_allocations;
+
+/// Stateful allocator used to check that vector_t routes all its memory
+/// management through its allocator, and follows the propagation traits.
+template<typename T, bool Propagate>
+struct tracking_allocator_t {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+    /// Identifies the arena the allocator draws from.
+    int id;
+
+    explicit tracking_allocator_t(int i = 0) : id(i) {}
+
+    template<typename U>
+    tracking_allocator_t(tracking_allocator_t<U, Propagate> const &other) : id(other.id) {}
+
+    T *allocate(std::size_t n) {
+        live_allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        live_allocations--;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(tracking_allocator_t const &other) const { return id == other.id; }
+};
+
+} // namespace al
+
+TEST_CASE("Allocator awareness") {
+    // Empty allocators should not take any room
+    CHECK(sizeof(vector_t<int>) == sizeof(int *) + 2 * sizeof(std::size_t));
+
+    using propagating_t = al::tracking_allocator_t<int, true>;
+    using sticky_t = al::tracking_allocator_t<int, false>;
+
+    al::live_allocations = 0;
+
+    {
+        vector_t<int, propagating_t> a(propagating_t(1));
+        for (int i = 0; i < 100; i++) {
+            a.emplace_back(i);
+        }
+        CHECK(al::live_allocations == 1);
+        CHECK(a.get_allocator().id == 1);
+
+        // Copy construction keeps the allocator
+        vector_t<int, propagating_t> b(a);
+        CHECK(b.get_allocator().id == 1);
+        CHECK(al::live_allocations == 2);
+
+        // Propagating allocators follow copy assignment...
+        vector_t<int, propagating_t> c(propagating_t(2));
+        c.emplace_back(0);
+        c = a;
+        CHECK(c.get_allocator().id == 1);
+        CHECK(c.size() == 100);
+        CHECK(c[99] == 99);
+        CHECK(al::live_allocations == 3);
+
+        // ... move assignment, which steals the buffer...
+        vector_t<int, propagating_t> d(propagating_t(3));
+        d = std::move(c);
+        CHECK(d.get_allocator().id == 1);
+        CHECK(d[42] == 42);
+        CHECK(c.size() == 0);
+        CHECK(al::live_allocations == 3);
+
+        // ... and swap.
+        vector_t<int, propagating_t> e(propagating_t(4));
+        e.swap(d);
+        CHECK(e.get_allocator().id == 1);
+        CHECK(d.get_allocator().id == 4);
+        CHECK(e.size() == 100);
+    }
+
+    CHECK(al::live_allocations == 0);
+
+    {
+        vector_t<int, sticky_t> a(sticky_t(1));
+        for (int i = 0; i < 100; i++) {
+            a.emplace_back(i);
+        }
+
+        // Non-propagating allocators stay in place on copy assignment
+        vector_t<int, sticky_t> b(sticky_t(2));
+        b = a;
+        CHECK(b.get_allocator().id == 2);
+        CHECK(b[99] == 99);
+
+        // Move assigning between unequal allocators moves values one by one
+        vector_t<int, sticky_t> c(sticky_t(3));
+        c = std::move(a);
+        CHECK(c.get_allocator().id == 3);
+        CHECK(c.size() == 100);
+        CHECK(c[99] == 99);
+
+        // The allocator-extended move constructor behaves the same
+        vector_t<int, sticky_t> d(std::move(c), sticky_t(4));
+        CHECK(d.get_allocator().id == 4);
+        CHECK(d[99] == 99);
+        CHECK(al::live_allocations == 4);
+    }
+
+    CHECK(al::live_allocations == 0);
+}
+
+/// Memory resource that forwards to another one and counts allocations.
+struct counting_resource_t : std::pmr::memory_resource {
+    std::pmr::memory_resource *upstream = std::pmr::new_delete_resource();
+    long allocations = 0;
+    long deallocations = 0;
+
+    void *do_allocate(std::size_t bytes, std::size_t align) override {
+        allocations++;
+        return upstream->allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t align) override {
+        deallocations++;
+        upstream->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_CASE("Polymorphic allocators") {
+    SECTION("Monotonic buffer resource") {
+        // Growing to 100 values needs 16 + 32 + 64 + 128 ints: everything must
+        // fit in the stack buffer since there is no upstream resource
+        alignas(std::max_align_t) std::byte buffer[4096];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                                  std::pmr::null_memory_resource());
+
+        pmr::vector_t<int> vec(&arena);
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back(i);
+        }
+
+        CHECK(vec.size() == 100);
+        CHECK(vec[99] == 99);
+        CHECK(vec.get_allocator().resource() == &arena);
+        CHECK(reinterpret_cast<std::byte *>(vec.begin()) >= buffer);
+        CHECK(reinterpret_cast<std::byte *>(vec.end()) <= buffer + sizeof(buffer));
+    }
+
+    SECTION("Nested vectors use the resource of their parent") {
+        counting_resource_t counter;
+        std::pmr::monotonic_buffer_resource arena(&counter);
+
+        {
+            pmr::vector_t<pmr::vector_t<int>> outer(&arena);
+            for (int i = 0; i < 20; i++) {
+                outer.emplace_back();
+                outer[i].emplace_back(i);
+            }
+
+            CHECK(outer[19].get_allocator().resource() == &arena);
+            CHECK(outer[19][0] == 19);
+        }
+
+        // The arena is the only client of the counting resource
+        CHECK(counter.allocations > 0);
+        CHECK(counter.deallocations == 0);
+        arena.release();
+        CHECK(counter.deallocations == counter.allocations);
+    }
+
+    SECTION("Unsynchronized pool resource") {
+        counting_resource_t counter;
+        std::pmr::unsynchronized_pool_resource pool(&counter);
+
+        auto fill = [&pool] {
+            pmr::vector_t<int> vec(&pool);
+            for (int i = 0; i < 1000; i++) {
+                vec.emplace_back(i);
+            }
+            return std::accumulate(vec.begin(), vec.end(), 0);
+        };
+
+        CHECK(fill() == 499500);
+        long const warm_allocations = counter.allocations;
+
+        // Blocks given back to the pool are reused by the next vectors
+        for (int i = 0; i < 10; i++) {
+            CHECK(fill() == 499500);
+        }
+        CHECK(counter.allocations == warm_allocations);
+    }
+}
+
+/// Type whose move constructor and destructor are not trivial, but that
+/// opts into trivial relocation: relocating it must not run either of them.
+struct relocatable_t {
+    static inline unsigned moves = 0;
+    static inline unsigned destructions = 0;
+
+    int value;
+
+    explicit relocatable_t(int v = 0) : value(v) {}
+    relocatable_t(relocatable_t &&other) : value(other.value) { moves++; }
+    ~relocatable_t() { destructions++; }
+};
+
+template<>
+struct is_trivially_relocatable<relocatable_t> : std::true_type {};
+
+TEST_CASE("Trivially relocatable values") {
+    static_assert(is_trivially_relocatable_v<int>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(!is_trivially_relocatable_v<lt::observer_t>);
+    static_assert(has_reallocate_v<malloc_allocator_t<int>, int>);
+    static_assert(!has_reallocate_v<std::allocator<int>, int>);
+
+    SECTION("Opt-in types are relocated without moves or destructions") {
+        vector_t<relocatable_t> vec;
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back(i);
+        }
+        vec.reserve(1000);
+        vec.resize(50);
+
+        CHECK(relocatable_t::moves == 0);
+        CHECK(relocatable_t::destructions == 50);
+        CHECK(vec[49].value == 49);
+    }
+
+    SECTION("Owning pointers survive relocation") {
+        vector_t<std::unique_ptr<int>> vec;
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back(std::make_unique<int>(i));
+        }
+        vec.reserve(1000);
+
+        for (int i = 0; i < 100; i++) {
+            CHECK(*vec[i] == i);
+        }
+    }
+
+    SECTION("Buffers are reallocated in place by malloc_allocator_t") {
+        vector_t<int, malloc_allocator_t<int>> vec;
+        for (int i = 0; i < 100000; i++) {
+            vec.emplace_back(i);
+        }
+        vec.resize(200000);
+
+        CHECK(vec.size() == 200000);
+        CHECK(vec.capacity() >= 200000);
+        CHECK(std::accumulate(vec.begin(), vec.begin() + 100000, 0L) == 4999950000L);
+
+        vector_t<int, malloc_allocator_t<int>> copy(vec);
+        CHECK(copy[99999] == 99999);
+    }
+}
+
+TEST_CASE("Value and default initialization") {
+    SECTION("Trivial values are value-initialized") {
+        vector_t<int> vec(64);
+        CHECK(std::count(vec.begin(), vec.end(), 0) == 64);
+
+        std::fill(vec.begin(), vec.end(), 7);
+        vec.resize(16);
+        vec.resize(128);
+        CHECK(std::count(vec.begin(), vec.begin() + 16, 7) == 16);
+        CHECK(std::count(vec.begin() + 16, vec.end(), 0) == 112);
+    }
+
+    SECTION("Pointers to data members are null, even inside structs") {
+        // Null pointers to data members are not zero bytes on common ABIs
+        struct member_t {
+            int value;
+        };
+        struct holder_t {
+            int member_t::*member;
+        };
+        static_assert(!is_zero_initializable_v<int member_t::*>);
+        static_assert(!is_zero_initializable_v<holder_t>);
+
+        vector_t<holder_t> vec(2);
+        CHECK(vec[1].member == nullptr);
+        vec.resize(1000, parallel_init(thread_pool_t::global(), 0, 0));
+        CHECK(vec[999].member == nullptr);
+
+        small_vector_t<holder_t, 4> small(3);
+        CHECK(small[2].member == nullptr);
+
+        segmented_vector_t<holder_t> segmented;
+        segmented.resize(100);
+        CHECK(segmented[99].member == nullptr);
+
+        soa_vector_t<int, holder_t> soa;
+        soa.resize(10);
+        CHECK(std::get<1>(soa[9]).member == nullptr);
+
+#if defined(__linux__)
+        vm_vector_t<holder_t> vm(5);
+        CHECK(vm[4].member == nullptr);
+#endif
+    }
+
+    SECTION("resize_for_overwrite keeps live values") {
+        vector_t<int> vec(4, default_init);
+        CHECK(vec.size() == 4);
+        std::iota(vec.begin(), vec.end(), 0);
+
+        vec.resize_for_overwrite(1000);
+        CHECK(vec.size() == 1000);
+        CHECK(vec[3] == 3);
+
+        vec.resize_for_overwrite(2);
+        CHECK(vec.size() == 2);
+        CHECK(vec[1] == 1);
+    }
+
+    SECTION("Non-trivial values are still default constructed") {
+        lt::zero();
+        {
+            vector_t<lt::observer_t> vec(32, default_init);
+            CHECK(lt::construction_default == 32);
+
+            vec.resize_for_overwrite(64);
+            CHECK(lt::construction_default == 64);
+            CHECK(lt::construction_move == 32);
+            CHECK(lt::destruction == 32);
+
+            vec.resize_for_overwrite(16);
+            CHECK(lt::destruction == 80);
+        }
+        CHECK(lt::destruction == 96);
+        lt::zero();
+    }
+
+    SECTION("Default-initialized nested vectors use the outer memory resource") {
+        std::pmr::monotonic_buffer_resource arena;
+        pmr::vector_t<pmr::vector_t<int>> vec(4, default_init, &arena);
+        vec.resize_for_overwrite(8);
+        for (auto const &inner : vec) {
+            CHECK(inner.get_allocator().resource() == &arena);
+        }
+    }
+}
+
+TEST_CASE("small_vector_t: lifetime management in inline and heap states") {
+    lt::zero();
+
+    {
+        small_vector_t<lt::observer_t, 4> vec;
+        small_vector_t<lt::observer_t, 4> const &cref = vec;
+
+        // Filling the inline storage should only construct values
+
+        for (int i = 0; i < 4; i++) {
+            vec.emplace_back();
+        }
+
+        CHECK(cref.is_inline());
+        CHECK(cref.size() == 4);
+        CHECK(cref.capacity() == 4);
+
+        CHECK(lt::construction_default == 4);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Spilling to the heap should move the 4 inline values
+
+        vec.emplace_back();
+
+        CHECK(!cref.is_inline());
+        CHECK(cref.size() == 5);
+        CHECK(cref.capacity() == 8);
+
+        CHECK(lt::construction_default == 1);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 4);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 4);
+        lt::zero();
+
+        // Moving a vector in the heap state should do nothing
+
+        small_vector_t<lt::observer_t, 4> heap_moved(std::move(vec));
+
+        CHECK(!heap_moved.is_inline());
+        CHECK(heap_moved.size() == 5);
+        CHECK(cref.is_inline());
+        CHECK(cref.size() == 0);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Copying a vector in the heap state should copy-construct its values
+
+        small_vector_t<lt::observer_t, 4> heap_copy(heap_moved);
+
+        CHECK(!heap_copy.is_inline());
+        CHECK(heap_copy.size() == 5);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 5);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // The moved-from vector should be reusable
+
+        vec.resize(3);
+
+        CHECK(cref.is_inline());
+        CHECK(lt::construction_default == 3);
+        lt::zero();
+
+        // Copying a vector in the inline state should stay inline
+
+        small_vector_t<lt::observer_t, 4> inline_copy(vec);
+
+        CHECK(inline_copy.is_inline());
+        CHECK(inline_copy.size() == 3);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 3);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Moving a vector in the inline state should move its values one by
+        // one, and destroy the moved-from values
+
+        small_vector_t<lt::observer_t, 4> inline_moved(std::move(vec));
+
+        CHECK(inline_moved.is_inline());
+        CHECK(inline_moved.size() == 3);
+        CHECK(cref.size() == 0);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 3);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 3);
+        lt::zero();
+
+        // Move assigning a heap vector over an inline vector should destroy
+        // the inline values and steal the heap buffer
+
+        inline_moved = std::move(heap_copy);
+
+        CHECK(!inline_moved.is_inline());
+        CHECK(inline_moved.size() == 5);
+        CHECK(heap_copy.is_inline());
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 3);
+        lt::zero();
+
+        // Copy assigning an inline vector over a heap vector should destroy
+        // the heap values and copy-construct (not copy-assign) the others
+
+        inline_copy.emplace_back();
+        lt::zero();
+        inline_moved = inline_copy;
+
+        CHECK(inline_moved.size() == 4);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 4);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 5);
+        lt::zero();
+    }
+
+    // heap_moved (5 values), heap_copy (0), inline_copy (4) and
+    // inline_moved (4) remain
+
+    CHECK(lt::construction_default == 0);
+    CHECK(lt::construction_copy == 0);
+    CHECK(lt::construction_move == 0);
+    CHECK(lt::assign_copy == 0);
+    CHECK(lt::assign_move == 0);
+    CHECK(lt::destruction == 13);
+    lt::zero();
+}
+
+TEST_CASE("small_vector_t: values across states") {
+    small_vector_t<int, 8> a;
+    small_vector_t<int, 8> b;
+    for (int i = 0; i < 5; i++) {
+        a.emplace_back(i);
+    }
+    for (int i = 0; i < 100; i++) {
+        b.emplace_back(i);
+    }
+
+    CHECK(a.is_inline());
+    CHECK(!b.is_inline());
+
+    swap(a, b);
+
+    CHECK(a.size() == 100);
+    CHECK(a[99] == 99);
+    CHECK(b.size() == 5);
+    CHECK(b[4] == 4);
+    CHECK(b.is_inline());
+
+    b.resize(20);
+    CHECK(!b.is_inline());
+    CHECK(b[4] == 4);
+    CHECK(std::count(b.begin() + 5, b.end(), 0) == 15);
+
+    small_vector_t<std::unique_ptr<int>, 2> owners;
+    for (int i = 0; i < 10; i++) {
+        owners.emplace_back(std::make_unique<int>(i));
+    }
+    CHECK(*owners[9] == 9);
+}
+
+/// Builds {0, 1, ..., n - 1} at compile time
+template<std::size_t N>
+constexpr inplace_vector_t<int, N> make_iota(int n) {
+    inplace_vector_t<int, N> vec;
+    for (int i = 0; i < n; i++) {
+        vec.emplace_back(i);
+    }
+    return vec;
+}
+
+TEST_CASE("inplace_vector_t: compile-time properties") {
+    static_assert(std::is_trivially_copyable_v<inplace_vector_t<int, 8>>);
+    static_assert(!std::is_trivially_copyable_v<inplace_vector_t<lt::observer_t, 8>>);
+    static_assert(!std::is_trivially_copyable_v<inplace_vector_t<std::unique_ptr<int>, 8>>);
+
+    constexpr auto vec = make_iota<8>(5);
+    static_assert(vec.size() == 5);
+    static_assert(vec[4] == 4);
+    static_assert(inplace_vector_t<int, 8>(3)[2] == 0);
+
+    static_assert([] {
+        auto full = make_iota<4>(4);
+        return full.try_emplace_back(4) == nullptr && full.size() == 4;
+    }());
+
+    CHECK(std::accumulate(vec.begin(), vec.end(), 0) == 10);
+}
+
+TEST_CASE("inplace_vector_t: lifetime management") {
+    lt::zero();
+
+    {
+        inplace_vector_t<lt::observer_t, 4> vec;
+        inplace_vector_t<lt::observer_t, 4> const &cref = vec;
+
+        // Nothing is constructed until values are emplaced
+
+        CHECK(lt::construction_default == 0);
+
+        vec.emplace_back();
+        vec.emplace_back();
+        vec.emplace_back();
+        CHECK(vec.try_emplace_back() != nullptr);
+
+        CHECK(cref.size() == 4);
+        CHECK(lt::construction_default == 4);
+        lt::zero();
+
+        // A full vector should refuse new values without constructing them
+
+        CHECK(vec.try_emplace_back() == nullptr);
+        CHECK_THROWS_AS(vec.emplace_back(), std::bad_alloc);
+        CHECK_THROWS_AS(vec.resize(5), std::bad_alloc);
+
+        CHECK(cref.size() == 4);
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Copying should copy-construct 4 values
+
+        inplace_vector_t<lt::observer_t, 4> copy(vec);
+
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 4);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Moving should move-construct 4 values, the moved-from values being
+        // still alive
+
+        inplace_vector_t<lt::observer_t, 4> moved(std::move(copy));
+
+        CHECK(copy.size() == 4);
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 4);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Copy assigning 4 values over 2 values should assign over the 2
+        // live values and copy-construct the 2 others
+
+        inplace_vector_t<lt::observer_t, 4> target(2);
+        lt::zero();
+        target = vec;
+
+        CHECK(target.size() == 4);
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 2);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 2);
+        CHECK(lt::assign_move == 0);
+        CHECK(lt::destruction == 0);
+        lt::zero();
+
+        // Move assigning 1 value over 4 values should move-assign 1 value and
+        // destroy the 3 others
+
+        inplace_vector_t<lt::observer_t, 4> single(1);
+        lt::zero();
+        target = std::move(single);
+
+        CHECK(target.size() == 1);
+        CHECK(lt::construction_default == 0);
+        CHECK(lt::construction_copy == 0);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::assign_copy == 0);
+        CHECK(lt::assign_move == 1);
+        CHECK(lt::destruction == 3);
+        lt::zero();
+
+        // Resizing down should destroy values
+
+        vec.resize(1);
+
+        CHECK(lt::destruction == 3);
+        lt::zero();
+    }
+
+    // vec (1 value), copy (4), moved (4), target (1) and single (1) remain
+
+    CHECK(lt::construction_default == 0);
+    CHECK(lt::construction_copy == 0);
+    CHECK(lt::construction_move == 0);
+    CHECK(lt::assign_copy == 0);
+    CHECK(lt::assign_move == 0);
+    CHECK(lt::destruction == 11);
+    lt::zero();
+}
+
+/// Returns the successive capacities of a vector growing up to n values.
+template<typename GrowthPolicy>
+std::vector<std::size_t> capacities(std::size_t n) {
+    vector_t<int, std::allocator<int>, GrowthPolicy> vec;
+    std::vector<std::size_t> result;
+    for (std::size_t i = 0; i < n; i++) {
+        vec.emplace_back(0);
+        if (result.empty() || result.back() != vec.capacity())
+            result.push_back(vec.capacity());
+    }
+    return result;
+}
+
+TEST_CASE("Growth policies") {
+    using sizes_t = std::vector<std::size_t>;
+
+    CHECK(capacities<doubling_growth_t<>>(100) == sizes_t{16, 32, 64, 128});
+    CHECK(capacities<doubling_growth_t<1>>(5) == sizes_t{1, 2, 4, 8});
+    CHECK(capacities<factor_growth_t<3, 2, 4>>(20) == sizes_t{4, 6, 9, 13, 19, 28});
+    CHECK(capacities<fixed_increment_growth_t<10>>(35) == sizes_t{10, 20, 30, 40});
+    CHECK(capacities<fixed_increment_growth_t<10, 5>>(20) == sizes_t{5, 15, 25});
+
+    // 16 ints = 64 bytes, 24 ints = 96 bytes, then 36 ints = 144 bytes which
+    // is rounded up to the 160 bytes class (40 ints)...
+    CHECK(capacities<size_class_growth_t<>>(100) == sizes_t{16, 24, 40, 64, 96, 160});
+
+    CHECK(round_to_size_class(1) == 16);
+    CHECK(round_to_size_class(129) == 160);
+    CHECK(round_to_size_class(1000) == 1024);
+    CHECK(round_to_size_class(1025) == 1280);
+    CHECK(round_to_size_class(200000) == 200704);
+}
+
+TEST_CASE("Malloc slack is used as capacity") {
+    static_assert(has_allocate_at_least_v<malloc_allocator_t<int>, int>);
+    static_assert(!has_allocate_at_least_v<std::allocator<int>, int> ||
+                  __cplusplus > 202002L);
+
+    vector_t<char, malloc_allocator_t<char>> vec;
+    vec.reserve(1);
+    CHECK(vec.capacity() >= 1);
+#if defined(__linux__)
+    CHECK(vec.capacity() == malloc_usable_size(vec.begin()));
+#endif
+
+    for (char c = 0; c < 100; c++) {
+        vec.emplace_back(c);
+    }
+    CHECK(vec.capacity() >= 100);
+#if defined(__linux__)
+    CHECK(vec.capacity() == malloc_usable_size(vec.begin()));
+#endif
+    CHECK(vec[99] == 99);
+
+    vector_t<std::string, malloc_allocator_t<std::string>> strings;
+    strings.reserve(3);
+    CHECK(strings.capacity() >= 3);
+    for (int i = 0; i < 100; i++) {
+        strings.emplace_back(std::to_string(i));
+    }
+    CHECK(strings[99] == "99");
+}
+
+#if defined(__linux__)
+TEST_CASE("Large buffers are remapped instead of copied") {
+    // Buffers of 64 KiB and more are mapped
+    using allocator_type = mmap_allocator_t<int, std::size_t(64) << 10>;
+    static_assert(has_reallocate_at_least_v<allocator_type, int>);
+
+    long const page_size = sysconf(_SC_PAGESIZE);
+    auto page_aligned = [page_size](void const *p) {
+        return reinterpret_cast<std::uintptr_t>(p) % std::uintptr_t(page_size) == 0;
+    };
+
+    vector_t<int, allocator_type> vec;
+    for (int i = 0; i < 1000; i++) {
+        vec.emplace_back(i);
+    }
+    CHECK(vec.capacity() * sizeof(int) < (64 << 10));
+
+    // Crossing the threshold moves the values to a mapping, whose pages are
+    // all used as capacity
+    for (int i = 1000; i < 100000; i++) {
+        vec.emplace_back(i);
+    }
+    CHECK(page_aligned(vec.begin()));
+    CHECK(vec.capacity() * sizeof(int) % std::size_t(page_size) == 0);
+
+    // Growing a mapping keeps the values
+    vec.resize(4'000'000);
+    CHECK(vec.size() == 4'000'000);
+    CHECK(page_aligned(vec.begin()));
+    CHECK(std::accumulate(vec.begin(), vec.begin() + 100000, 0L) == 4999950000L);
+    CHECK(std::count(vec.begin() + 100000, vec.end(), 0) == 3'900'000);
+
+    // Copies get their own mapping, and values that are not trivially
+    // relocatable are still relocated one by one
+    vector_t<int, allocator_type> copy(vec);
+    CHECK(copy[99999] == 99999);
+
+    vector_t<std::string, mmap_allocator_t<std::string, std::size_t(64) << 10>> strings;
+    for (int i = 0; i < 10000; i++) {
+        strings.emplace_back(std::to_string(i));
+    }
+    CHECK(strings[9999] == "9999");
+}
+#endif
+
+#if defined(__linux__)
+TEST_CASE("vm_vector_t: stable addresses") {
+    vm_vector_t<int> vec;
+    CHECK(vec.max_capacity() == vm_vector_t<int>::default_reservation / sizeof(int));
+    CHECK(vec.capacity() == 0);
+
+    vec.emplace_back(0);
+    int const *const first = &vec[0];
+    CHECK(vec.capacity() * sizeof(int) == vm_vector_t<int>::min_commit);
+
+    // Growing never moves values
+    for (int i = 1; i < 1'000'000; i++) {
+        vec.emplace_back(i);
+    }
+    CHECK(&vec[0] == first);
+    CHECK(vec[999'999] == 999'999);
+
+    vec.resize(3'000'000);
+    CHECK(&vec[0] == first);
+    CHECK(std::count(vec.begin() + 1'000'000, vec.end(), 0) == 2'000'000);
+
+    // Decommitting keeps the live values, and the range can grow again
+    vec.resize(10);
+    vec.decommit();
+    CHECK(vec.capacity() < 3'000'000);
+    CHECK(vec.capacity() >= 10);
+    CHECK(vec[9] == 9);
+    vec.resize(100'000);
+    CHECK(&vec[0] == first);
+    CHECK(vec[99'999] == 0);
+
+    // Moving hands over the range, copying reserves a new one
+    vm_vector_t<int> moved(std::move(vec));
+    CHECK(&moved[0] == first);
+    vm_vector_t<int> copy(moved);
+    CHECK(&copy[0] != first);
+    CHECK(copy[9] == 9);
+
+    // Moved-from vectors are still usable
+    vec.emplace_back(42);
+    CHECK(vec[0] == 42);
+
+    // Like vector_t, the size constructor constructs values
+    vm_vector_t<int> const sized(100);
+    CHECK(sized.size() == 100);
+    CHECK(sized[99] == 0);
+
+    // The reserved range is a hard limit
+    vm_vector_t<std::string> small(vm_reservation_t{1 << 16});
+    CHECK_THROWS_AS(small.reserve(small.max_capacity() + 1), std::bad_alloc);
+    for (std::size_t i = 0; i < small.max_capacity(); i++) {
+        small.emplace_back(std::to_string(i));
+    }
+    CHECK_THROWS_AS(small.emplace_back(), std::bad_alloc);
+    CHECK(small[100] == "100");
+
+    // Copy assignment replaces a range too small for the values of other
+    vm_vector_t<std::string> tiny(vm_reservation_t{4096});
+    tiny = small;
+    CHECK(tiny.size() == small.size());
+    CHECK(tiny.max_capacity() == small.max_capacity());
+    CHECK(tiny[100] == "100");
+}
+#endif
+
+/// Allocator counting every allocation, to make sure that some operations
+/// never allocate.
+template<typename T>
+struct counting_allocator_t {
+    using value_type = T;
+
+    static inline unsigned allocations = 0;
+
+    counting_allocator_t() = default;
+
+    template<typename U>
+    counting_allocator_t(counting_allocator_t<U> const &) {}
+
+    T *allocate(std::size_t n) {
+        allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    bool operator==(counting_allocator_t const &) const { return true; }
+};
+
+TEST_CASE("Allocation-free moves and capacity-reusing copies") {
+    using inner_t = vector_t<int, counting_allocator_t<int>>;
+    using outer_t = vector_t<inner_t, counting_allocator_t<inner_t>>;
+
+    static_assert(std::is_nothrow_move_constructible_v<inner_t>);
+    static_assert(std::is_nothrow_move_assignable_v<inner_t>);
+
+    SECTION("Moves never allocate") {
+        inner_t a(100);
+        counting_allocator_t<int>::allocations = 0;
+
+        inner_t b(std::move(a));
+        a = std::move(b);
+        b = std::move(a);
+        swap(a, b);
+
+        CHECK(counting_allocator_t<int>::allocations == 0);
+        CHECK(a.size() == 100);
+        CHECK(b.size() == 0);
+    }
+
+    SECTION("Sorting a vector of vectors never allocates") {
+        outer_t vecs;
+        for (int i = 0; i < 1000; i++) {
+            vecs.emplace_back();
+            vecs[i].emplace_back((i * 7919) % 1000);
+        }
+
+        counting_allocator_t<int>::allocations = 0;
+        counting_allocator_t<inner_t>::allocations = 0;
+
+        std::sort(vecs.begin(), vecs.end(),
+                  [](inner_t const &l, inner_t const &r) { return l[0] < r[0]; });
+
+        CHECK(counting_allocator_t<int>::allocations == 0);
+        CHECK(counting_allocator_t<inner_t>::allocations == 0);
+        for (int i = 0; i < 1000; i++) {
+            CHECK(vecs[i][0] == i);
+        }
+    }
+
+    SECTION("Copy assignment reuses the existing capacity") {
+        inner_t small(10);
+        inner_t large(1000);
+        std::iota(large.begin(), large.end(), 0);
+
+        counting_allocator_t<int>::allocations = 0;
+        large = small;
+        CHECK(counting_allocator_t<int>::allocations == 0);
+        CHECK(large.size() == 10);
+        CHECK(large.capacity() == 1000);
+        CHECK(large[9] == 0);
+
+        small = inner_t(100);
+        counting_allocator_t<int>::allocations = 0;
+        large = small;
+        CHECK(counting_allocator_t<int>::allocations == 0);
+        CHECK(large.size() == 100);
+
+        // A buffer too small for the values should be replaced
+        inner_t tiny(1);
+        counting_allocator_t<int>::allocations = 0;
+        tiny = large;
+        CHECK(counting_allocator_t<int>::allocations == 1);
+        CHECK(tiny.size() == 100);
+    }
+}
+
+TEST_CASE("Lifetime management and capacity-reusing copies") {
+    vector_t<lt::observer_t> a(32);
+    vector_t<lt::observer_t> b(16);
+    vector_t<lt::observer_t> c(8);
+    c.reserve(64);
+    lt::zero();
+
+    // Copy assigning 32 values over 16 values does not fit in the buffer of
+    // b: the 16 values are destroyed, then the 32 values are copy-constructed
+    // in a new buffer
+
+    b = a;
+
+    CHECK(lt::construction_default == 0);
+    CHECK(lt::construction_copy == 32);
+    CHECK(lt::construction_move == 0);
+    CHECK(lt::assign_copy == 0);
+    CHECK(lt::assign_move == 0);
+    CHECK(lt::destruction == 16);
+    lt::zero();
+
+    // Copy assigning 32 values over 8 values with enough capacity should
+    // copy-assign 8 values and copy-construct 24 values
+
+    c = a;
+
+    CHECK(lt::construction_default == 0);
+    CHECK(lt::construction_copy == 24);
+    CHECK(lt::construction_move == 0);
+    CHECK(lt::assign_copy == 8);
+    CHECK(lt::assign_move == 0);
+    CHECK(lt::destruction == 0);
+    lt::zero();
+
+    // Copy assigning 8 values over 32 values should copy-assign 8 values and
+    // destroy 24 values
+
+    c.resize(8);
+    b = c;
+    lt::zero();
+    a = b;
+
+    CHECK(lt::construction_default == 0);
+    CHECK(lt::construction_copy == 0);
+    CHECK(lt::construction_move == 0);
+    CHECK(lt::assign_copy == 8);
+    CHECK(lt::assign_move == 0);
+    CHECK(lt::destruction == 24);
+    lt::zero();
+}
+
+TEST_CASE("segmented_vector_t: stable addresses") {
+    static_assert(std::random_access_iterator<segmented_vector_t<int>::iterator>);
+    static_assert(std::random_access_iterator<segmented_vector_t<int>::const_iterator>);
+
+    segmented_vector_t<int, std::allocator<int>, 4> vec;
+    CHECK(vec.capacity() == 0);
+    CHECK(vec.segment_count() == 0);
+    CHECK(vec.segment(0).empty());
+
+    int const &first = vec.emplace_back(0);
+    CHECK(vec.capacity() == 4);
+
+    // Growing allocates segments of 4, 4, 8, 16... values, and never moves
+    // values
+    std::vector<int const *> addresses{&first};
+    for (int i = 1; i < 1000; i++) {
+        addresses.push_back(&vec.emplace_back(i));
+    }
+    CHECK(vec.size() == 1000);
+    CHECK(vec.capacity() == 1024);
+    CHECK(vec.segment_count() == 9);
+    CHECK(vec.segment(0).size() == 4);
+    CHECK(vec.segment(1).size() == 4);
+    CHECK(vec.segment(8).size() == 1000 - 512);
+    // Segments past the live values are empty, even unallocated ones
+    vec.reserve(2000);
+    CHECK(vec.segment(9).empty());
+    CHECK(vec.segment(vec.max_segments + 1).empty());
+    CHECK(std::as_const(vec).segment(10).empty());
+    for (int i = 0; i < 1000; i++) {
+        REQUIRE(&vec[std::size_t(i)] == addresses[std::size_t(i)]);
+        REQUIRE(vec[std::size_t(i)] == i);
+    }
+
+    // Iterating across segments, by iterator and by segment
+    CHECK(std::accumulate(vec.begin(), vec.end(), 0) == 999 * 1000 / 2);
+    CHECK(vec.end() - vec.begin() == 1000);
+    CHECK(*(vec.begin() + 600) == 600);
+    CHECK(*(vec.end() - 1) == 999);
+    int sum = 0;
+    for (std::size_t k = 0; k < vec.segment_count(); k++) {
+        for (int v : vec.segment(k)) {
+            sum += v;
+        }
+    }
+    CHECK(sum == 999 * 1000 / 2);
+    std::reverse(vec.begin(), vec.end());
+    CHECK(vec[0] == 999);
+    CHECK(std::is_sorted(vec.begin(), vec.end(), std::greater<>()));
+    std::sort(vec.begin(), vec.end());
+    CHECK(vec[999] == 999);
+
+    // Resizing value-initializes across segments, shrinking keeps segments
+    // until shrink_to_fit
+    vec.resize(3000);
+    CHECK(std::count(vec.begin() + 1000, vec.end(), 0) == 2000);
+    vec.resize(10);
+    CHECK(vec.capacity() == 4096);
+    vec.shrink_to_fit();
+    CHECK(vec.capacity() == 16);
+    CHECK(&vec[0] == &first);
+
+    // Moving hands over the segments, copying allocates new ones
+    segmented_vector_t<int, std::allocator<int>, 4> moved(std::move(vec));
+    CHECK(&moved[0] == &first);
+    CHECK(vec.size() == 0);
+    segmented_vector_t<int, std::allocator<int>, 4> copy(moved);
+    CHECK(&copy[0] != &first);
+    CHECK(copy[9] == 9);
+
+    // Moved-from vectors are still usable
+    vec.emplace_back(42);
+    CHECK(vec[0] == 42);
+}
+
+TEST_CASE("segmented_vector_t: lifetime management") {
+    lt::zero();
+    {
+        segmented_vector_t<lt::observer_t, std::allocator<lt::observer_t>, 2> vec;
+
+        // Growing never moves or copies values
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back();
+        }
+        CHECK(lt::construction_default == 100);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::construction_copy == 0);
+        lt::zero();
+
+        vec.resize(50);
+        CHECK(lt::destruction == 50);
+        vec.resize(60);
+        CHECK(lt::construction_default == 10);
+        lt::zero();
+
+        // Copy assignment reuses the segments
+        segmented_vector_t<lt::observer_t, std::allocator<lt::observer_t>, 2> copy;
+        copy.resize(5);
+        lt::zero();
+        copy = vec;
+        CHECK(lt::destruction == 5);
+        CHECK(lt::construction_copy == 60);
+        lt::zero();
+
+        segmented_vector_t<lt::observer_t, std::allocator<lt::observer_t>, 2> moved;
+        moved = std::move(copy);
+        CHECK(moved.size() == 60);
+        CHECK(lt::construction_move == 0);
+        CHECK(lt::destruction == 0);
+    }
+    CHECK(lt::destruction == 120);
+    lt::zero();
+}
+
+TEST_CASE("concurrent_vector_t: concurrent appends") {
+    constexpr int thread_count = 8;
+    constexpr int values_per_thread = 10'000;
+    constexpr std::size_t total = thread_count * values_per_thread;
+
+    concurrent_vector_t<std::string, std::allocator<std::string>, 4> vec;
+    CHECK(vec.segment(0).empty());
+    std::atomic<bool> done{false};
+
+    // Catch2 assertions are not thread-safe, so threads count their failures
+    std::atomic<int> failures{0};
+
+    // A reader checks that every published value is fully constructed while
+    // the writers are appending
+    std::thread reader([&] {
+        std::size_t checked = 0;
+        while (!done.load() || checked < vec.size()) {
+            for (std::size_t s = vec.size(); checked < s; checked++) {
+                if (vec[checked].empty())
+                    failures++;
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < thread_count; t++) {
+        writers.emplace_back([&, t] {
+            std::vector<std::string const *> mine;
+            for (int i = 0; i < values_per_thread; i++) {
+                mine.push_back(&vec.emplace_back(std::to_string(t * values_per_thread + i)));
+            }
+            // Returned references stay valid while other threads append
+            for (int i = 0; i < values_per_thread; i++) {
+                if (*mine[std::size_t(i)] != std::to_string(t * values_per_thread + i))
+                    failures++;
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    done.store(true);
+    reader.join();
+    CHECK(failures == 0);
+
+    // Every value was appended exactly once
+    REQUIRE(vec.size() == total);
+    CHECK(vec.segment(vec.segment_count()).empty());
+    CHECK(vec.segment(vec.max_segments + 1).empty());
+    std::vector<int> values;
+    for (std::size_t k = 0; k < vec.segment_count(); k++) {
+        for (std::string const &value : vec.segment(k)) {
+            values.push_back(std::stoi(value));
+        }
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<int> expected(total);
+    std::iota(expected.begin(), expected.end(), 0);
+    CHECK(values == expected);
+}
+
+/// Value counting its lifetime events with atomic counters, for values
+/// constructed from several threads.
+struct atomic_observer_t {
+    static inline std::atomic<unsigned> constructions{0};
+    static inline std::atomic<unsigned> copies_and_moves{0};
+    static inline std::atomic<unsigned> destructions{0};
+
+    atomic_observer_t() { constructions++; }
+    atomic_observer_t(atomic_observer_t const &) { copies_and_moves++; }
+    atomic_observer_t(atomic_observer_t &&) { copies_and_moves++; }
+    ~atomic_observer_t() { destructions++; }
+};
+
+TEST_CASE("concurrent_vector_t: lifetime management") {
+    {
+        concurrent_vector_t<atomic_observer_t> vec;
+        vec.reserve(100);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; t++) {
+            writers.emplace_back([&vec] {
+                for (int i = 0; i < 250; i++) {
+                    vec.emplace_back();
+                }
+            });
+        }
+        for (auto &writer : writers) {
+            writer.join();
+        }
+        CHECK(vec.size() == 1000);
+    }
+    // Values are never moved or copied, and all of them are destroyed
+    CHECK(atomic_observer_t::constructions == 1000);
+    CHECK(atomic_observer_t::copies_and_moves == 0);
+    CHECK(atomic_observer_t::destructions == 1000);
+}
+
+TEST_CASE("concurrent_vector_t: throwing constructors") {
+    struct throwing_t {
+        std::string value;
+
+        explicit throwing_t(int i) : value(std::to_string(i)) {
+            if (i % 7 == 0)
+                throw std::runtime_error("throwing_t");
+        }
+    };
+
+    constexpr int thread_count = 4;
+    constexpr int values_per_thread = 1000;
+    concurrent_vector_t<throwing_t, std::allocator<throwing_t>, 4> vec;
+    std::atomic<int> thrown{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < thread_count; t++) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < values_per_thread; i++) {
+                try {
+                    vec.emplace_back(t * values_per_thread + i);
+                } catch (std::runtime_error const &) {
+                    thrown++;
+                }
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    // Failed slots do not hold back the published size, but hold no value
+    REQUIRE(vec.size() == thread_count * values_per_thread);
+    std::vector<int> values;
+    int failed = 0;
+    for (std::size_t i = 0; i < vec.size(); i++) {
+        if (vec.holds_value(i))
+            values.push_back(std::stoi(vec[i].value));
+        else
+            failed++;
+    }
+    CHECK(failed == thrown);
+    std::sort(values.begin(), values.end());
+    std::vector<int> expected;
+    for (int i = 0; i < thread_count * values_per_thread; i++) {
+        if (i % 7 != 0)
+            expected.push_back(i);
+    }
+    CHECK(values == expected);
+}
+
+/// Makes byte_failing_allocator_t fail while set.
+static bool fail_byte_allocations = false;
+
+/// Allocator whose allocations of one-byte objects, like the slot states of
+/// concurrent_vector_t, fail while fail_byte_allocations is set.
+template<typename T>
+struct byte_failing_allocator_t {
+    using value_type = T;
+
+    byte_failing_allocator_t() = default;
+
+    template<typename U>
+    byte_failing_allocator_t(byte_failing_allocator_t<U> const &) {}
+
+    T *allocate(std::size_t n) {
+        if (sizeof(T) == 1 && fail_byte_allocations)
+            throw std::bad_alloc();
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    bool operator==(byte_failing_allocator_t const &) const { return true; }
+};
+
+TEST_CASE("concurrent_vector_t: failed allocations") {
+    concurrent_vector_t<int, byte_failing_allocator_t<int>, 4> vec;
+    for (int i = 0; i < 4; i++) {
+        vec.emplace_back(i);
+    }
+
+    // The slot states of the second segment cannot be allocated: no slot is
+    // claimed, and later appends are still published
+    fail_byte_allocations = true;
+    CHECK_THROWS_AS(vec.emplace_back(4), std::bad_alloc);
+    fail_byte_allocations = false;
+    CHECK(vec.size() == 4);
+    vec.emplace_back(5);
+    REQUIRE(vec.size() == 5);
+    CHECK(vec.holds_value(4));
+    CHECK(vec[4] == 5);
+}
+
+TEST_CASE("spmc_vector_t: readers see consistent snapshots while the writer grows") {
+    constexpr int value_count = 50'000;
+    constexpr int reader_count = 4;
+
+    spmc_vector_t<std::string, std::allocator<std::string>, 2> vec;
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::atomic<long> snapshots{0};
+
+    // Readers check that every value of their snapshot is there, while at
+    // most 2 of them hold a snapshot at once
+    std::vector<std::thread> readers;
+    for (int r = 0; r < reader_count; r++) {
+        readers.emplace_back([&] {
+            do {
+                auto const snapshot = vec.snapshot();
+                std::size_t const s = snapshot.size();
+                if (s && snapshot[s - 1] != std::to_string(s - 1))
+                    failures++;
+                if (s && snapshot[s / 2] != std::to_string(s / 2))
+                    failures++;
+                snapshots++;
+                std::this_thread::yield();
+            } while (!done.load());
+        });
+    }
+
+    for (int i = 0; i < value_count; i++) {
+        vec.emplace_back(std::to_string(i));
+    }
+    done.store(true);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    CHECK(failures == 0);
+    CHECK(snapshots > 0);
+
+    // Once the readers are gone, every retired buffer can be reclaimed
+    CHECK(vec.reclaim() == 0);
+    auto const snapshot = vec.snapshot();
+    REQUIRE(snapshot.size() == value_count);
+    for (int i = 0; i < value_count; i++) {
+        REQUIRE(snapshot[std::size_t(i)] == std::to_string(i));
+    }
+}
+
+TEST_CASE("spmc_vector_t: snapshots delay reclamation") {
+    lt::zero();
+    {
+        spmc_vector_t<lt::observer_t> vec;
+        for (int i = 0; i < 16; i++) {
+            vec.emplace_back();
+        }
+        CHECK(vec.capacity() == 16);
+
+        // Growing copies the values, since the old ones may still be read
+        std::optional<spmc_vector_t<lt::observer_t>::snapshot_t> snapshot(vec.snapshot());
+        vec.emplace_back();
+        CHECK(lt::construction_copy == 16);
+        CHECK(lt::construction_move == 0);
+        CHECK(snapshot->size() == 16);
+
+        // The old buffer is kept alive until the snapshot is released
+        CHECK(lt::destruction == 0);
+        CHECK(vec.retired_count() == 1);
+        CHECK(vec.reclaim() == 1);
+        snapshot.reset();
+        CHECK(vec.reclaim() == 0);
+        CHECK(lt::destruction == 16);
+    }
+    CHECK(lt::construction_default + lt::construction_copy == lt::destruction);
+    lt::zero();
+}
+
+TEST_CASE("Parallel algorithms") {
+    constexpr std::size_t n = 100'000;
+    thread_pool_t pool(4);
+    thread_pool_t single(1);
+    CHECK(pool.thread_count() == 4);
+    CHECK(single.thread_count() == 1);
+
+    vector_t<long> vec(n);
+    parallel_for(n, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            vec[i] = long(i);
+        }
+    }, 1000, pool);
+    CHECK(vec[n - 1] == long(n - 1));
+
+    SECTION("parallel_for and parallel_transform") {
+        parallel_for(vec, [](long &v) { v *= 2; }, 0, pool);
+        CHECK(vec[12345] == 24690);
+
+        vector_t<double> halves(n);
+        parallel_transform(vec, halves, [](long v) { return double(v) / 4; }, 777, pool);
+        CHECK(halves[12345] == 6172.5);
+    }
+
+    SECTION("parallel_reduce gives the same result on any number of threads") {
+        long const expected = long(n) * long(n - 1) / 2;
+        CHECK(parallel_reduce(vec, 0L, std::plus<>(), 0, pool) == expected);
+        CHECK(parallel_reduce(vec, 0L, std::plus<>(), 0, single) == expected);
+        CHECK(parallel_reduce(vector_t<long>(), 3L, std::plus<>(), 0, pool) == 3);
+
+        vector_t<double> values(n);
+        parallel_transform(vec, values, [](long v) { return 1.0 / double(v + 1); }, 0, pool);
+        CHECK(parallel_reduce(values, 0.0, std::plus<>(), 1024, pool) ==
+              parallel_reduce(values, 0.0, std::plus<>(), 1024, single));
+        // The default grain only depends on the number of values
+        CHECK(parallel_reduce(values, 0.0, std::plus<>(), 0, pool) ==
+              parallel_reduce(values, 0.0, std::plus<>(), 0, single));
+        vector_t<double> pool_sums(n), single_sums(n);
+        parallel_scan(values, pool_sums, std::plus<>(), 0, pool);
+        parallel_scan(values, single_sums, std::plus<>(), 0, single);
+        CHECK(std::equal(pool_sums.begin(), pool_sums.end(), single_sums.begin()));
+
+        long const max = parallel_reduce(vec, 0L, [](long a, long b) { return std::max(a, b); },
+                                         0, pool);
+        CHECK(max == long(n - 1));
+    }
+
+    SECTION("parallel_scan") {
+        vector_t<long> ones(n);
+        parallel_for(ones, [](long &v) { v = 1; }, 0, pool);
+        vector_t<long> sums(n);
+        parallel_scan(ones, sums, std::plus<>(), 999, pool);
+        for (std::size_t i = 0; i < n; i++) {
+            REQUIRE(sums[i] == long(i + 1));
+        }
+
+        // In place, with a single chunk and with single values
+        vector_t<long> small(5);
+        parallel_for(small, [](long &v) { v = 2; }, 0, pool);
+        parallel_scan(small, small, std::plus<>(), 100, pool);
+        CHECK(small[4] == 10);
+        parallel_scan(vec, vec, std::plus<>(), 1, pool);
+        CHECK(vec[n - 1] == std::accumulate(sums.begin(), sums.end(), 0L) - long(n));
+    }
+
+    SECTION("parallel_sort") {
+        std::reverse(vec.begin(), vec.end());
+        parallel_sort(vec, std::less<>(), 1000, pool);
+        CHECK(std::is_sorted(vec.begin(), vec.end()));
+
+        vector_t<std::string> words;
+        for (std::size_t i = 0; i < 10'000; i++) {
+            words.emplace_back(std::to_string((i * 7919) % 10'000));
+        }
+        std::vector<std::string> expected_words(words.begin(), words.end());
+        std::sort(expected_words.begin(), expected_words.end(), std::greater<>());
+        parallel_sort(words, std::greater<>(), 100, pool);
+        CHECK(std::equal(words.begin(), words.end(), expected_words.begin()));
+        CHECK(words[0] == "9999");
+
+        // Runs of odd sizes, with the default grain and a single chunk
+        for (std::size_t grain : {std::size_t(0), std::size_t(777), n}) {
+            vector_t<long> scrambled(n);
+            for (std::size_t i = 0; i < n; i++) {
+                scrambled[i] = long((i * 2654435761u) % 1000);
+            }
+            std::vector<long> expected(scrambled.begin(), scrambled.end());
+            std::sort(expected.begin(), expected.end());
+            parallel_sort(scrambled, std::less<>(), grain, pool);
+            CHECK(std::equal(scrambled.begin(), scrambled.end(), expected.begin()));
+        }
+
+        // Many equal values
+        vector_t<int> few(n);
+        parallel_for(n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                few[i] = int(i % 3);
+            }
+        }, 0, pool);
+        parallel_sort(few, std::less<>(), 100, pool);
+        CHECK(std::is_sorted(few.begin(), few.end()));
+    }
+
+    SECTION("Exceptions are rethrown") {
+        CHECK_THROWS_AS(parallel_for(vec, [](long v) {
+            if (v == 5000)
+                throw std::runtime_error("5000");
+        }, 100, pool), std::runtime_error);
+    }
+}
+
+TEST_CASE("Parallel first-touch initialization") {
+    thread_pool_t pool(4);
+    constexpr std::size_t n = std::size_t(1) << 20;
+
+    // Trivial values are zeroed by slices
+    vector_t<int> ints(n, parallel_init(pool));
+    CHECK(ints.size() == n);
+    CHECK(ints.capacity() == n);
+    CHECK(std::count(ints.begin(), ints.end(), 0) == long(n));
+
+    // Growing keeps the live values, and zeroes the new ones
+    ints[n - 1] = 42;
+    ints.resize(3 * n, parallel_init(pool, 4096));
+    CHECK(ints[n - 1] == 42);
+    CHECK(std::count(ints.begin(), ints.end(), 0) == long(3 * n - 1));
+    ints.resize(10, parallel_init(pool));
+    CHECK(ints.size() == 10);
+
+    // Values whose default constructor cannot throw are constructed by slices
+    vector_t<std::string> strings(n, parallel_init(pool, 0, 0));
+    CHECK(std::all_of(strings.begin(), strings.end(), [](std::string const &v) { return v.empty(); }));
+
+    // Others are constructed on the calling thread, as are small vectors
+    static_assert(!std::is_nothrow_default_constructible_v<atomic_observer_t>);
+    unsigned const constructions = atomic_observer_t::constructions;
+    {
+        vector_t<atomic_observer_t> observers(1000, parallel_init(pool, 0, 0));
+        CHECK(atomic_observer_t::constructions - constructions == 1000);
+    }
+    vector_t<long> small(100, parallel_init(pool));
+    CHECK(std::count(small.begin(), small.end(), 0) == 100);
+}
+
+/// Kernels for the dispatch tests, returning their level.
+int scalar_kernel(int x) { return x; }
+int sse2_kernel(int x) { return x + 1; }
+int avx512_kernel(int x) { return x + 3; }
+
+TEST_CASE("CPU dispatch") {
+    CHECK(parse_simd_level("avx2") == simd_level_t::avx2);
+    CHECK(parse_simd_level("scalar") == simd_level_t::scalar);
+    CHECK(parse_simd_level("AVX2") == std::nullopt);
+    CHECK(parse_simd_level("") == std::nullopt);
+    for (std::size_t l = 0; l < simd_level_count; l++) {
+        CHECK(parse_simd_level(simd_level_name(simd_level_t(l))) == simd_level_t(l));
+    }
+    CHECK(simd_level() <= detected_simd_level());
+
+    // Missing levels use the kernel below, and levels the CPU does not
+    // support are never used
+    simd_dispatch_t<int(int)> const dispatch(scalar_kernel, sse2_kernel, nullptr, avx512_kernel);
+    int const detected = int(detected_simd_level());
+    CHECK(dispatch.at(simd_level_t::scalar)(0) == 0);
+    CHECK(dispatch.at(simd_level_t::sse2)(0) == std::min(detected, 1));
+    CHECK(dispatch.at(simd_level_t::avx2)(0) == std::min(detected, 1));
+    CHECK(dispatch.at(simd_level_t::avx512)(0) == (detected == 3 ? 3 : std::min(detected, 1)));
+    CHECK(dispatch(10) == dispatch.at(simd_level())(10));
+
+    simd_dispatch_t<int(int)> const scalar_only(scalar_kernel);
+    CHECK(scalar_only.at(simd_level_t::avx512)(5) == 5);
+}
+
+TEMPLATE_TEST_CASE("SIMD search kernels", "", std::int8_t, std::uint8_t, std::int16_t,
+                   std::uint16_t, std::int32_t, std::uint32_t, std::int64_t, std::uint64_t, float,
+                   double) {
+    using T = TestType;
+    vector_t<T> vec;
+    for (std::size_t i = 0; i < 1000; i++) {
+        vec.emplace_back(T((i * 37) % 101));
+    }
+    vec[700] = T(120);
+    vec[800] = T(120);
+    vec[900] = T(0);
+
+    // Every level the CPU supports, on ranges of any size and alignment
+    for (int l = 0; l <= int(detected_simd_level()); l++) {
+        simd_level_t const level = simd_level_t(l);
+        for (std::size_t offset = 0; offset < 4; offset++) {
+            for (std::size_t size = 0; offset + size <= vec.size(); size += size < 300 ? 1 : 97) {
+                std::span<T const> const range(vec.begin() + offset, size);
+                for (T value : {T(0), T(36), T(120), T(100)}) {
+                    REQUIRE(simd_find(range, value, level) ==
+                            std::find(range.begin(), range.end(), value) - range.begin() +
+                                range.data());
+                    REQUIRE(simd_count(range, value, level) ==
+                            std::size_t(std::count(range.begin(), range.end(), value)));
+                    REQUIRE(simd_contains(range, value, level) ==
+                            (std::find(range.begin(), range.end(), value) != range.end()));
+                }
+                REQUIRE(simd_min_element(range, level) ==
+                        std::min_element(range.begin(), range.end()) - range.begin() +
+                            range.data());
+                REQUIRE(simd_max_element(range, level) ==
+                        std::max_element(range.begin(), range.end()) - range.begin() +
+                            range.data());
+                if (size > 0) {
+                    auto const [min, max] = std::minmax_element(range.begin(), range.end());
+                    REQUIRE(simd_minmax(range, level) == std::pair(*min, *max));
+                }
+            }
+        }
+
+        // Counts do not overflow the vector lanes
+        vector_t<T> same(100'000);
+        std::fill(same.begin(), same.end(), T(7));
+        CHECK(simd_count(same, T(7), level) == 100'000);
+
+        // Non-constant ranges give non-constant pointers
+        T *found = simd_find(vec, T(120), level);
+        CHECK(found == vec.begin() + 700);
+        CHECK(simd_max_element(vec, level) == found);
+        CHECK(*simd_min_element(vec, level) == T(0));
+    }
+}
+
+TEST_CASE("SIMD search kernels: NaNs") {
+    vector_t<double> vec(100);
+    std::fill(vec.begin(), vec.end(), 1.0);
+    vec[50] = std::numeric_limits<double>::quiet_NaN();
+    for (int l = 0; l <= int(detected_simd_level()); l++) {
+        simd_level_t const level = simd_level_t(l);
+        CHECK(simd_find(vec, vec[50], level) == vec.end());
+        CHECK(simd_count(vec, 1.0, level) == 99);
+        CHECK(simd_min_element(vec, level) != vec.end());
+        CHECK(simd_max_element(vec, level) != vec.end());
+    }
+}
+
+TEST_CASE("soa_vector_t: columns and rows") {
+    soa_vector_t<int, double, char> soa;
+    CHECK(soa.size() == 0);
+    CHECK(soa.capacity() == 0);
+    CHECK(soa.column<0>().empty());
+
+    for (int i = 0; i < 100; i++) {
+        auto [id, value, tag] = soa.emplace_back(i, i * 0.5, char('a' + i % 26));
+        CHECK(id == i);
+        CHECK(value == i * 0.5);
+        CHECK(tag == 'a' + i % 26);
+    }
+    CHECK(soa.size() == 100);
+    CHECK(soa.capacity() >= 100);
+
+    // Each column is contiguous and starts on its own cache line
+    std::span<int> ids = soa.column<0>();
+    std::span<double> values = soa.column<1>();
+    CHECK(ids.size() == 100);
+    CHECK(values.size() == 100);
+    CHECK(reinterpret_cast<std::uintptr_t>(values.data()) % 64 ==
+          reinterpret_cast<std::uintptr_t>(ids.data()) % 64);
+    CHECK(std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+
+    // Rows are tuples of references into the columns
+    std::get<1>(soa[10]) = -1.0;
+    CHECK(values[10] == -1.0);
+    soa[20] = std::tuple(-20, -10.0, 'z');
+    CHECK(ids[20] == -20);
+    CHECK(std::get<2>(soa[20]) == 'z');
+
+    // Growth preserves the rows
+    soa.reserve(1000);
+    CHECK(soa.capacity() == 1000);
+    CHECK(soa.column<0>()[99] == 99);
+    CHECK(soa.column<1>()[10] == -1.0);
+    CHECK(soa.column<2>()[25] == 'z');
+
+    soa.resize(150);
+    CHECK(soa.column<0>()[120] == 0);
+    CHECK(soa.column<1>()[149] == 0.0);
+    soa.resize(10);
+    CHECK(soa.size() == 10);
+    CHECK(soa.capacity() == 1000);
+
+    soa_vector_t<int, double, char> const copy(soa);
+    CHECK(copy.size() == 10);
+    CHECK(copy[9] == std::tuple(9, 4.5, 'j'));
+    CHECK(copy.column<1>().data() != soa.column<1>().data());
+}
+
+TEST_CASE("soa_vector_t: lifetime management") {
+    lt::zero();
+    {
+        soa_vector_t<lt::observer_t, int> soa;
+        for (int i = 0; i < 4; i++) {
+            soa.emplace_back(lt::observer_t(), i);
+        }
+        CHECK(lt::construction_default == 4);
+        lt::zero();
+
+        // Relocation moves the values of non-trivial columns one by one
+        soa.reserve(100);
+        CHECK(lt::construction_move == 4);
+        CHECK(lt::destruction == 4);
+        lt::zero();
+
+        soa.resize(10);
+        CHECK(lt::construction_default == 6);
+        CHECK(soa.column<1>()[9] == 0);
+        soa.resize(8);
+        CHECK(lt::destruction == 2);
+        lt::zero();
+
+        soa_vector_t<lt::observer_t, int> copy;
+        copy.resize(3);
+        lt::zero();
+        copy = soa;
+        CHECK(lt::destruction == 3);
+        CHECK(lt::construction_copy == 8);
+        lt::zero();
+
+        soa_vector_t<lt::observer_t, int> moved(std::move(copy));
+        CHECK(moved.size() == 8);
+        CHECK(copy.size() == 0);
+        CHECK(lt::construction_move == 0);
+    }
+    CHECK(lt::destruction == 16);
+    lt::zero();
+
+    // A row whose construction throws is rolled back
+    struct throwing_t {
+        throwing_t(int i) {
+            if (i < 0)
+                throw std::runtime_error("throwing_t");
+        }
+    };
+    {
+        soa_vector_t<lt::observer_t, throwing_t> soa;
+        soa.emplace_back(lt::observer_t(), 1);
+        lt::zero();
+        CHECK_THROWS_AS(soa.emplace_back(lt::observer_t(), -1), std::runtime_error);
+        CHECK(soa.size() == 1);
+        CHECK(lt::construction_move == 1);
+        CHECK(lt::destruction == 2);
+    }
+    lt::zero();
+}
+
+/// Aggregate struct for soa_struct_vector_t.
+struct order_t {
+    std::int64_t id;
+    float price;
+    float quantity;
+    std::string symbol;
+};
+
+TEST_CASE("soa_struct_vector_t: columns of aggregate structs") {
+    using orders_t = soa_struct_vector_t<order_t>;
+    static_assert(orders_t::column_count == 4);
+    static_assert(std::is_same_v<decltype(std::declval<orders_t &>().col<&order_t::price>()),
+                                 std::span<float>>);
+    static_assert(std::is_same_v<decltype(std::declval<orders_t const &>().col<&order_t::symbol>()),
+                                 std::span<std::string const>>);
+
+    orders_t orders;
+    for (int i = 0; i < 50; i++) {
+        orders.push_back(order_t{i, float(i) / 2, float(i), std::to_string(i)});
+    }
+    order_t const order{50, 25.f, 50.f, "50"};
+    orders.push_back(order);
+    orders.emplace_back(51, 25.5f, 51.f, "51");
+    CHECK(orders.size() == 52);
+
+    // Fields of the same type map to their own column
+    std::span<float> prices = orders.col<&order_t::price>();
+    std::span<float> quantities = orders.col<&order_t::quantity>();
+    CHECK(prices.data() != quantities.data());
+    CHECK(prices.size() == 52);
+    CHECK(prices[10] == 5.f);
+    CHECK(quantities[10] == 10.f);
+    CHECK(orders.col<&order_t::id>()[51] == 51);
+    CHECK(orders.col<&order_t::symbol>()[42] == "42");
+    CHECK(orders.column<1>().data() == prices.data());
+
+    prices[7] = -1.f;
+    order_t const seventh = orders.value(7);
+    CHECK(seventh.id == 7);
+    CHECK(seventh.price == -1.f);
+    CHECK(seventh.symbol == "7");
+
+    auto [id, price, quantity, symbol] = orders[8];
+    symbol = "eight";
+    CHECK(orders.col<&order_t::symbol>()[8] == "eight");
+    CHECK(id == 8);
+
+    orders_t const copy(orders);
+    CHECK(copy.col<&order_t::symbol>()[8] == "eight");
+    CHECK(copy.columns().capacity() >= 52);
+}
+
+/// Aggregate struct with a non-trivial field.
+struct observed_particle_t {
+    float mass;
+    lt::observer_t observer;
+};
+
+TEST_CASE("soa_struct_vector_t: lifetime management") {
+    using particle_t = observed_particle_t;
+
+    lt::zero();
+    {
+        soa_struct_vector_t<particle_t> particles;
+        particles.reserve(4);
+        particle_t particle{1.f, {}};
+        lt::zero();
+
+        // Fields are copied or moved into their column
+        particles.push_back(particle);
+        CHECK(lt::construction_copy == 1);
+        particles.push_back(std::move(particle));
+        CHECK(lt::construction_move == 1);
+        lt::zero();
+
+        particles.resize(3);
+        CHECK(lt::construction_default == 1);
+        CHECK(particles.col<&particle_t::mass>()[2] == 0.f);
+        particles.resize(1);
+        CHECK(lt::destruction == 2);
+        lt::zero();
+
+        soa_struct_vector_t<particle_t> moved;
+        moved = std::move(particles);
+        CHECK(moved.size() == 1);
+        CHECK(lt::construction_move == 0);
+    }
+    // The moved-from particle and the row
+    CHECK(lt::destruction == 2);
+    lt::zero();
+}
+
+/// Aggregate struct for aosoa_vector_t.
+struct body_t {
+    float x, y, z;
+    float vx, vy, vz;
+    std::int32_t id;
+};
+
+TEST_CASE("aosoa_vector_t: tiles") {
+    using bodies_t = aosoa_vector_t<body_t, 16>;
+    static_assert(bodies_t::field_count == 7);
+    static_assert(bodies_t::tile_bytes == 7 * 64);
+    static_assert(aosoa_vector_t<body_t, 3>::field_alignment<0> == 8);
+    static_assert(aosoa_vector_t<body_t, 3>::tile_bytes == 128);
+    static_assert(std::random_access_iterator<bodies_t::tile_iterator>);
+    static_assert(
+        std::ranges::random_access_range<decltype(std::declval<bodies_t const &>().tiles())>);
+
+    bodies_t bodies;
+    CHECK(bodies.tiles().empty());
+    for (int i = 0; i < 40; i++) {
+        float const f = float(i);
+        bodies.push_back(body_t{f, 2 * f, 3 * f, 1, 1, 1, i});
+    }
+    CHECK(bodies.size() == 40);
+    CHECK(bodies.capacity() % 16 == 0);
+    CHECK(bodies.tile_count() == 3);
+
+    // Tiles hold the fields of 16 values, in cache-line-aligned arrays
+    std::size_t i = 0;
+    for (auto tile : bodies.tiles()) {
+        CHECK(tile.size() == (i < 32 ? 16u : 8u));
+        std::span<float> x = tile.col<&body_t::x>();
+        std::span<float> vx = tile.col<&body_t::vx>();
+        CHECK(reinterpret_cast<std::uintptr_t>(x.data()) % 64 == 0);
+        CHECK(vx.data() == x.data() + 3 * 16);
+        CHECK(tile.column<6>()[0] == std::int32_t(i));
+        for (std::size_t l = 0; l < x.size(); l++) {
+            CHECK(x[l] == float(i + l));
+            x[l] += vx[l];
+        }
+        i += tile.size();
+    }
+    CHECK(i == 40);
+
+    body_t const body = bodies.value(33);
+    CHECK(body.x == 34.f);
+    CHECK(body.y == 66.f);
+    CHECK(body.id == 33);
+    auto [x, y, z, vx, vy, vz, id] = bodies[20];
+    CHECK(x == 21.f);
+    z = -1.f;
+    CHECK(bodies.tiles()[1].col<&body_t::z>()[4] == -1.f);
+
+    // Capacity grows and is reserved by whole tiles
+    bodies.reserve(100);
+    CHECK(bodies.capacity() == 112);
+    CHECK(bodies.value(39).x == 40.f);
+    bodies.resize(50);
+    CHECK(bodies.tile_count() == 4);
+    CHECK(bodies.value(49).id == 0);
+    bodies.resize(16);
+    CHECK(bodies.tile_count() == 1);
+
+    bodies_t const copy(bodies);
+    CHECK(copy.size() == 16);
+    CHECK(copy.tiles()[0].col<&body_t::x>()[15] == 16.f);
+}
+
+TEST_CASE("aosoa_vector_t: lifetime management") {
+    using particle_t = observed_particle_t;
+
+    lt::zero();
+    {
+        aosoa_vector_t<particle_t, 8> particles;
+        for (int i = 0; i < 10; i++) {
+            particles.emplace_back(float(i), lt::observer_t());
+        }
+        CHECK(particles.capacity() == 16);
+        lt::zero();
+
+        // Relocation moves the non-trivial fields one by one
+        particles.reserve(17);
+        CHECK(particles.capacity() == 24);
+        CHECK(lt::construction_move == 10);
+        CHECK(lt::destruction == 10);
+        CHECK(particles.tiles()[1].col<&particle_t::mass>()[1] == 9.f);
+        lt::zero();
+
+        particles.resize(20);
+        CHECK(lt::construction_default == 10);
+        particles.resize(12);
+        CHECK(lt::destruction == 8);
+        lt::zero();
+
+        aosoa_vector_t<particle_t, 8> copy;
+        copy.resize(3);
+        lt::zero();
+        copy = particles;
+        CHECK(lt::destruction == 3);
+        CHECK(lt::construction_copy == 12);
+        lt::zero();
+
+        aosoa_vector_t<particle_t, 8> moved(std::move(copy));
+        CHECK(moved.size() == 12);
+        CHECK(lt::construction_move == 0);
+    }
+    CHECK(lt::destruction == 24);
+    lt::zero();
+}
+
+/// Tells whether p is aligned on alignment bytes.
+static bool is_aligned(void const *p, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+TEST_CASE("Over-aligned buffers") {
+    static_assert(vector_t<int>::alignment == alignof(int));
+    static_assert(aligned_vector_t<int>::alignment == 64);
+    static_assert(aligned_vector_t<double, 128>::alignment == 128);
+    static_assert(allocator_alignment_v<aligned_allocator_t<char, 32>, char> == 32);
+
+    SECTION("Every buffer is aligned") {
+        aligned_vector_t<float> vec;
+        CHECK(vec.data() == nullptr);
+        for (int i = 0; i < 1000; i++) {
+            vec.emplace_back(float(i));
+            CHECK(is_aligned(vec.data(), 64));
+        }
+        CHECK(vec.begin() == vec.data());
+        CHECK(vec[999] == 999.f);
+
+        aligned_vector_t<float> const copy(vec);
+        CHECK(is_aligned(copy.data(), 64));
+        CHECK(copy[500] == 500.f);
+    }
+
+    SECTION("Capacity is rounded up to whole blocks") {
+        aligned_vector_t<float> vec;
+        vec.reserve(1);
+        CHECK(vec.capacity() == 16);
+        vec.reserve(17);
+        CHECK(vec.capacity() == 32);
+
+        // 48 bytes values: 2 values fit in 2 blocks of 64 bytes, 4 in 3
+        struct record_t {
+            std::int64_t a, b, c, d, e, f;
+        };
+        aligned_vector_t<record_t> records;
+        records.reserve(2);
+        CHECK(records.capacity() == 2);
+        records.reserve(3);
+        CHECK(records.capacity() == 4);
+        CHECK(is_aligned(records.data(), 64));
+    }
+
+    SECTION("Lifetime management") {
+        lt::zero();
+        {
+            aligned_vector_t<lt::observer_t> vec;
+            vec.resize(10);
+            CHECK(is_aligned(vec.data(), 64));
+            vec.reserve(100);
+            CHECK(is_aligned(vec.data(), 64));
+            CHECK(lt::construction_default == 10);
+            CHECK(lt::construction_move == 10);
+            CHECK(lt::destruction == 10);
+        }
+        CHECK(lt::destruction == 20);
+        lt::zero();
+    }
+
+    SECTION("Polymorphic base allocator") {
+        // The memory resource is asked for the alignment of the blocks
+        std::pmr::monotonic_buffer_resource arena;
+        using allocator_t = aligned_allocator_t<int, 256, std::pmr::polymorphic_allocator<int>>;
+        vector_t<int, allocator_t> vec{allocator_t(&arena)};
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back(i);
+            CHECK(is_aligned(vec.data(), 256));
+        }
+        CHECK(vec.get_allocator() == allocator_t(&arena));
+        CHECK(vec.get_allocator() != allocator_t());
+    }
+}
@@ -0,0 +1,788 @@
+/// Benchmarks for vector_t and its siblings.
+
+// Every operation is measured on vector_t and on std::vector as a baseline,
+// over three kinds of values:
+// - int, which is trivial,
+// - observer_t, whose constructors and destructor do something, like
+// lt::observer_t in vector.cpp,
+// - large_t, a 256 bytes trivially copyable struct.
+
+// Benchmarks can be selected by tag, eg. ./vector_bench "[emplace_back]".
+
+// Besides the Catch2 statistics, every benchmark prints the hardware counters
+// of one more run, divided by the number of values it handles (see
+// perf_counters.hpp).
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "aligned_allocator.hpp"
+#include "aosoa_vector.hpp"
+#include "concurrent_vector.hpp"
+#include "parallel.hpp"
+#include "perf_counters.hpp"
+#include "simd.hpp"
+#include "soa_vector.hpp"
+#include "vector.hpp"
+
+#if defined(__linux__)
+#include "mmap_allocator.hpp"
+#endif
+
+/// Non-trivial value, counting its lifetime events like lt::observer_t.
+struct observer_t {
+    static inline unsigned long events = 0;
+
+    int value;
+
+    observer_t() : value(0) { events++; }
+    explicit observer_t(int v) : value(v) { events++; }
+    observer_t(observer_t &&other) : value(other.value) { events++; }
+    observer_t(observer_t const &other) : value(other.value) { events++; }
+    observer_t &operator=(observer_t &&other) { return events++, value = other.value, *this; }
+    observer_t &operator=(observer_t const &other) { return events++, value = other.value, *this; }
+    ~observer_t() { events++; }
+};
+
+/// Large trivially copyable value.
+struct large_t {
+    std::array<int, 64> values;
+
+    large_t() = default;
+    explicit large_t(int v) : values{v} {}
+};
+
+/// Returns the value an element was built from.
+int key(int v) { return v; }
+int key(observer_t const &v) { return v.value; }
+int key(large_t const &v) { return v.values[0]; }
+
+/// Number of values in the containers under test.
+template<typename T>
+constexpr std::size_t value_count = sizeof(T) > 64 ? 100'000 : 1'000'000;
+
+/// Builds a container of n values.
+template<typename Container>
+Container make(std::size_t n) {
+    Container c;
+    c.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        c.emplace_back(int(i));
+    }
+    return c;
+}
+
+/// Printable names of the value types.
+template<typename T>
+constexpr char const *type_name = "int";
+template<>
+constexpr char const *type_name<observer_t> = "observer_t";
+template<>
+constexpr char const *type_name<large_t> = "large_t";
+
+/// Name of a benchmark on values of type T, for counter reports.
+template<typename T>
+std::string label(std::string const &name) {
+    return name + " <" + type_name<T> + ">";
+}
+
+/// Benchmarks fn with Catch2, then runs it once more under hardware counters
+/// to print per-operation figures, ops being the number of operations fn
+/// performs.
+template<typename Fn>
+void measure(std::string const &name, std::size_t ops, Fn &&fn) {
+    BENCHMARK(std::string(name)) { return fn(); };
+    perf_counters_t::report(name, ops, fn);
+}
+
+/// Same as measure(name, ops, fn), for a benchmark on values of type T.
+template<typename T, typename Fn>
+void measure(std::string const &name, std::size_t ops, Fn &&fn) {
+    BENCHMARK(std::string(name)) { return fn(); };
+    perf_counters_t::report(label<T>(name), ops, fn);
+}
+
+#define VALUE_TYPES int, observer_t, large_t
+
+TEMPLATE_TEST_CASE("emplace_back throughput", "[emplace_back]", VALUE_TYPES) {
+    constexpr std::size_t n = value_count<TestType>;
+
+    measure<TestType>("vector_t", n, [&] {
+        vector_t<TestType> vec;
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+
+    measure<TestType>("std::vector", n, [&] {
+        std::vector<TestType> vec;
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+
+    measure<TestType>("vector_t, reserved", n, [&] {
+        vector_t<TestType> vec;
+        vec.reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+
+    measure<TestType>("std::vector, reserved", n, [&] {
+        std::vector<TestType> vec;
+        vec.reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+}
+
+TEMPLATE_TEST_CASE("reserve and resize", "[reserve][resize]", VALUE_TYPES) {
+    constexpr std::size_t n = value_count<TestType>;
+
+    BENCHMARK_ADVANCED("vector_t, reserve(2n)")(Catch::Benchmark::Chronometer meter) {
+        std::vector<vector_t<TestType>> vecs(std::size_t(meter.runs()));
+        for (auto &vec : vecs) {
+            vec = make<vector_t<TestType>>(n);
+        }
+        meter.measure([&](int i) { vecs[std::size_t(i)].reserve(2 * n); });
+    };
+
+    {
+        auto vec = make<vector_t<TestType>>(n);
+        perf_counters_t::report(label<TestType>("vector_t, reserve(2n)"), n, [&] {
+            vec.reserve(2 * n);
+            return vec.capacity();
+        });
+    }
+
+    BENCHMARK_ADVANCED("std::vector, reserve(2n)")(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::vector<TestType>> vecs(std::size_t(meter.runs()));
+        for (auto &vec : vecs) {
+            vec = make<std::vector<TestType>>(n);
+        }
+        meter.measure([&](int i) { vecs[std::size_t(i)].reserve(2 * n); });
+    };
+
+    {
+        auto vec = make<std::vector<TestType>>(n);
+        perf_counters_t::report(label<TestType>("std::vector, reserve(2n)"), n, [&] {
+            vec.reserve(2 * n);
+            return vec.capacity();
+        });
+    }
+
+    measure<TestType>("vector_t, resize(n)", n, [&] {
+        vector_t<TestType> vec;
+        vec.resize(n);
+        return vec.size();
+    });
+
+    measure<TestType>("std::vector, resize(n)", n, [&] {
+        std::vector<TestType> vec;
+        vec.resize(n);
+        return vec.size();
+    });
+}
+
+TEMPLATE_TEST_CASE("copy and move", "[copy][move]", VALUE_TYPES) {
+    constexpr std::size_t n = value_count<TestType>;
+    auto const vec = make<vector_t<TestType>>(n);
+    auto const std_vec = make<std::vector<TestType>>(n);
+
+    measure<TestType>("vector_t, copy construction", n, [&] { return vector_t<TestType>(vec); });
+
+    measure<TestType>("std::vector, copy construction", n, [&] { return std::vector<TestType>(std_vec); });
+
+    vector_t<TestType> target = vec;
+    std::vector<TestType> std_target = std_vec;
+
+    measure<TestType>("vector_t, copy assignment", n, [&] {
+        target = vec;
+        return target.size();
+    });
+
+    measure<TestType>("std::vector, copy assignment", n, [&] {
+        std_target = std_vec;
+        return std_target.size();
+    });
+
+    measure<TestType>("vector_t, move construction and assignment", n, [&] {
+        vector_t<TestType> moved(std::move(target));
+        target = std::move(moved);
+        return target.size();
+    });
+
+    measure<TestType>("std::vector, move construction and assignment", n, [&] {
+        std::vector<TestType> moved(std::move(std_target));
+        std_target = std::move(moved);
+        return std_target.size();
+    });
+}
+
+TEMPLATE_TEST_CASE("iteration", "[iteration]", VALUE_TYPES) {
+    constexpr std::size_t n = value_count<TestType>;
+    auto const vec = make<vector_t<TestType>>(n);
+    auto const std_vec = make<std::vector<TestType>>(n);
+
+    measure<TestType>("vector_t, range-for", n, [&] {
+        long sum = 0;
+        for (auto const &v : vec) {
+            sum += key(v);
+        }
+        return sum;
+    });
+
+    measure<TestType>("std::vector, range-for", n, [&] {
+        long sum = 0;
+        for (auto const &v : std_vec) {
+            sum += key(v);
+        }
+        return sum;
+    });
+
+    measure<TestType>("vector_t, operator[]", n, [&] {
+        long sum = 0;
+        for (std::size_t i = 0; i < vec.size(); i++) {
+            sum += key(vec[i]);
+        }
+        return sum;
+    });
+
+    measure<TestType>("std::vector, operator[]", n, [&] {
+        long sum = 0;
+        for (std::size_t i = 0; i < std_vec.size(); i++) {
+            sum += key(std_vec[i]);
+        }
+        return sum;
+    });
+}
+
+TEMPLATE_TEST_CASE("construction of n values", "[construction]", VALUE_TYPES) {
+    constexpr std::size_t n = value_count<TestType>;
+
+    measure<TestType>("vector_t(n)", n, [&] { return vector_t<TestType>(n); });
+
+    measure<TestType>("std::vector(n)", n, [&] { return std::vector<TestType>(n); });
+}
+
+TEST_CASE("Construction of 1e7 ints", "[construction][init]") {
+    constexpr std::size_t n = 10'000'000;
+
+    measure("per-element construct_at", n, [&] {
+        std::allocator<int> allocator;
+        int *data = allocator.allocate(n);
+        for (std::size_t i = 0; i < n; i++) {
+            std::construct_at(data + i);
+        }
+        int const last = data[n - 1];
+        allocator.deallocate(data, n);
+        return last;
+    });
+
+    measure("vector_t<int>(N)", n, [&] {
+        vector_t<int> vec(n);
+        return vec[n - 1];
+    });
+
+    measure("vector_t<int>(N, default_init)", n, [&] {
+        vector_t<int> vec(n, default_init);
+        return vec.size();
+    });
+
+    measure("resize(N)", n, [&] {
+        vector_t<int> vec;
+        vec.resize(n);
+        return vec[n - 1];
+    });
+
+    measure("resize_for_overwrite(N)", n, [&] {
+        vector_t<int> vec;
+        vec.resize_for_overwrite(n);
+        return vec.size();
+    });
+}
+
+TEST_CASE("Short-lived vectors: global heap vs monotonic arena", "[pmr]") {
+    constexpr int vector_count = 1'000'000;
+    constexpr int values_per_vector = 8;
+    constexpr int vectors_per_request = 256;
+
+    measure("global heap", vector_count, [&] {
+        long sum = 0;
+        for (int i = 0; i < vector_count; i++) {
+            vector_t<int> vec;
+            for (int j = 0; j < values_per_vector; j++) {
+                vec.emplace_back(j);
+            }
+            sum += vec[values_per_vector - 1];
+        }
+        return sum;
+    });
+
+    measure("monotonic arena", vector_count, [&] {
+        // Each request gets its scratch vectors from a stack buffer, which is
+        // released all at once when the request is over
+        alignas(std::max_align_t) std::byte buffer[vectors_per_request * 16 * sizeof(int)];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        long sum = 0;
+        for (int i = 0; i < vector_count; i++) {
+            {
+                pmr::vector_t<int> vec(&arena);
+                for (int j = 0; j < values_per_vector; j++) {
+                    vec.emplace_back(j);
+                }
+                sum += vec[values_per_vector - 1];
+            }
+            if (i % vectors_per_request == vectors_per_request - 1) {
+                arena.release();
+            }
+        }
+        return sum;
+    });
+}
+
+/// Allocator recording the peak number of bytes held at once.
+template<typename T>
+struct peak_allocator_t {
+    using value_type = T;
+
+    static inline std::size_t live_bytes = 0;
+    static inline std::size_t peak_bytes = 0;
+
+    peak_allocator_t() = default;
+
+    template<typename U>
+    peak_allocator_t(peak_allocator_t<U> const &) {}
+
+    T *allocate(std::size_t n) {
+        live_bytes += n * sizeof(T);
+        peak_bytes = std::max(peak_bytes, live_bytes);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        live_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(peak_allocator_t const &) const { return true; }
+};
+
+/// Pushes n ints with the given policy, then reports the peak heap footprint
+/// (reached while relocating, when both buffers are alive) and the final
+/// capacity, relative to the n values that are actually needed.
+template<typename GrowthPolicy>
+void push_benchmark(char const *name, std::size_t n) {
+    using vector_type = vector_t<int, peak_allocator_t<int>, GrowthPolicy>;
+
+    measure(name, n, [&] {
+        vector_type vec;
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+
+    peak_allocator_t<int>::peak_bytes = 0;
+    vector_type vec;
+    for (std::size_t i = 0; i < n; i++) {
+        vec.emplace_back(int(i));
+    }
+    std::cout << name << ": peak heap footprint "
+              << double(peak_allocator_t<int>::peak_bytes) / double(n * sizeof(int))
+              << "x, final capacity " << double(vec.capacity()) / double(n)
+              << "x the size\n";
+}
+
+TEST_CASE("Growth policies: push throughput and peak footprint", "[growth]") {
+    // Just past a power of two, where doubling wastes the most
+    constexpr std::size_t n = (1 << 22) + 1;
+
+    push_benchmark<doubling_growth_t<>>("2x", n);
+    push_benchmark<factor_growth_t<3, 2>>("1.5x", n);
+    push_benchmark<size_class_growth_t<>>("1.5x, size classes", n);
+    push_benchmark<fixed_increment_growth_t<1 << 18>>("+256Ki values", n);
+    push_benchmark<doubling_growth_t<n>>("2x, initial capacity n", n);
+}
+
+#if defined(__linux__)
+TEST_CASE("Growing huge vectors: copy vs remap", "[huge]") {
+    constexpr std::size_t n = std::size_t(1) << 27;
+
+    measure("std::allocator, 512 MiB of ints", n, [&] {
+        vector_t<int> vec;
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+
+    measure("mmap_allocator_t, 512 MiB of ints", n, [&] {
+        vector_t<int, mmap_allocator_t<int>> vec;
+        for (std::size_t i = 0; i < n; i++) {
+            vec.emplace_back(int(i));
+        }
+        return vec.size();
+    });
+}
+#endif
+
+/// Runs fn on thread_count threads at once, and waits for all of them.
+template<typename Fn>
+void run_threads(unsigned thread_count, Fn const &fn) {
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; t++) {
+        threads.emplace_back(fn);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+TEST_CASE("Concurrent appends: lock-free vs mutex", "[concurrent]") {
+    // The same number of values is appended whatever the number of threads
+    constexpr std::size_t n = std::size_t(1) << 20;
+
+    for (unsigned thread_count : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        std::size_t const per_thread = n / thread_count;
+        std::string const threads = ", " + std::to_string(thread_count) + " threads";
+
+        measure("concurrent_vector_t" + threads, n, [&] {
+            concurrent_vector_t<int> vec;
+            run_threads(thread_count, [&] {
+                for (std::size_t i = 0; i < per_thread; i++) {
+                    vec.emplace_back(int(i));
+                }
+            });
+            return vec.size();
+        });
+
+        measure("mutex + vector_t" + threads, n, [&] {
+            std::mutex mutex;
+            vector_t<int> vec;
+            run_threads(thread_count, [&] {
+                for (std::size_t i = 0; i < per_thread; i++) {
+                    std::lock_guard lock(mutex);
+                    vec.emplace_back(int(i));
+                }
+            });
+            return vec.size();
+        });
+    }
+}
+
+TEST_CASE("Parallel algorithms on 1e8 doubles", "[parallel]") {
+    // Each run takes seconds: use eg. --benchmark-samples 5
+    constexpr std::size_t n = 100'000'000;
+
+    vector_t<double> input(n, default_init);
+    parallel_for(n, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            //a scrambled sequence, so that sorting has work to do
+            input[i] = double((i * 2654435761u) % n);
+        }
+    });
+    vector_t<double> output(n, default_init);
+
+    // Thread counts from 1 to all cores, doubling
+    vector_t<std::size_t> thread_counts;
+    std::size_t const cores = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t t = 1; t < cores; t *= 2) {
+        thread_counts.emplace_back(t);
+    }
+    thread_counts.emplace_back(cores);
+
+    for (std::size_t thread_count : thread_counts) {
+        thread_pool_t pool(thread_count);
+        std::string const threads = ", " + std::to_string(thread_count) + " threads";
+
+        measure("parallel_for" + threads, n, [&] {
+            parallel_for(n, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    output[i] = input[i] * 2.0 + 1.0;
+                }
+            }, 0, pool);
+            return output[n - 1];
+        });
+
+        measure("parallel_transform" + threads, n, [&] {
+            parallel_transform(input, output, [](double v) { return v * 2.0 + 1.0; }, 0, pool);
+            return output[n - 1];
+        });
+
+        measure("parallel_reduce" + threads, n, [&] {
+            return parallel_reduce(input, 0.0, std::plus<>(), 0, pool);
+        });
+
+        measure("parallel_scan" + threads, n, [&] {
+            parallel_scan(input, output, std::plus<>(), 0, pool);
+            return output[n - 1];
+        });
+
+        // Includes copying the input, which is small compared to sorting
+        measure("parallel_sort" + threads, n, [&] {
+            vector_t<double> values = input;
+            parallel_sort(values, std::less<>(), 0, pool);
+            return values[0];
+        });
+    }
+}
+
+TEST_CASE("Construction of 1e9 ints: serial vs parallel first touch", "[construction][first_touch]") {
+    // 4 GB per vector: use eg. --benchmark-samples 5
+    constexpr std::size_t n = 1'000'000'000;
+
+    measure("vector_t<int>(N)", n, [&] {
+        vector_t<int> vec(n);
+        return vec[n - 1];
+    });
+
+    std::size_t const cores = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t thread_count = 1;; thread_count = std::min(2 * thread_count, cores)) {
+        thread_pool_t pool(thread_count);
+        std::string const threads = ", " + std::to_string(thread_count) + " threads";
+
+        measure("vector_t<int>(N, parallel_init)" + threads, n, [&] {
+            vector_t<int> vec(n, parallel_init(pool));
+            return vec[n - 1];
+        });
+
+        measure("resize(N, parallel_init)" + threads, n, [&] {
+            vector_t<int> vec;
+            vec.resize(n, parallel_init(pool));
+            return vec[n - 1];
+        });
+
+        if (thread_count == cores)
+            break;
+    }
+}
+
+TEST_CASE("Searching int32_t columns: std vs SIMD kernels", "[simd]") {
+    // A column that fits in L2, where the kernels are compute bound, and one
+    // that does not, where they are bound by memory bandwidth. The searched
+    // value is absent, so that every value is scanned. Levels go up to
+    // simd_level(), which VECTOR_T_SIMD caps (eg. VECTOR_T_SIMD=avx2).
+    for (std::size_t n : {10'000, 10'000'000}) {
+        vector_t<std::int32_t> column(n, default_init);
+        for (std::size_t i = 0; i < n; i++) {
+            column[i] = std::int32_t((i * 2654435761u) % 1'000'000);
+        }
+        std::string const size = ", " + std::to_string(n) + " values";
+        std::int32_t const absent = -1;
+
+        measure("std::find" + size, n, [&] {
+            return std::find(column.begin(), column.end(), absent);
+        });
+        measure("std::count" + size, n, [&] {
+            return std::count(column.begin(), column.end(), absent);
+        });
+        measure("std::minmax_element" + size, n, [&] {
+            return *std::minmax_element(column.begin(), column.end()).first;
+        });
+
+        for (int l = 0; l <= int(simd_level()); l++) {
+            simd_level_t const level = simd_level_t(l);
+            std::string const name = std::string(", ") + simd_level_name(level) + size;
+
+            measure("simd_find" + name, n, [&] {
+                return simd_find(column, absent, level);
+            });
+            measure("simd_count" + name, n, [&] {
+                return simd_count(column, absent, level);
+            });
+            measure("simd_minmax" + name, n, [&] {
+                return simd_minmax(column, level).first;
+            });
+        }
+    }
+}
+
+/// Particle as a struct, for the array of structures layout.
+struct particle_t {
+    float x, y, z;
+    float mass;
+    std::int32_t id;
+    std::int32_t flags;
+    double energy;
+};
+
+TEST_CASE("Summing one field: array of structures vs structure of arrays", "[soa]") {
+    // The array of structures reads a whole 32 bytes particle_t for each
+    // float summed, the structure of arrays only reads the mass column.
+    for (std::size_t n : {10'000, 10'000'000}) {
+        vector_t<particle_t> aos;
+        soa_vector_t<float, float, float, float, std::int32_t, std::int32_t, double> soa;
+        soa_struct_vector_t<particle_t> mapped;
+        aos.reserve(n);
+        soa.reserve(n);
+        mapped.reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            float const mass = float(i % 100);
+            aos.emplace_back(particle_t{0, 0, 0, mass, std::int32_t(i), 0, 0});
+            soa.emplace_back(0.f, 0.f, 0.f, mass, std::int32_t(i), 0, 0.);
+            mapped.push_back(aos[i]);
+        }
+        std::string const size = ", " + std::to_string(n) + " particles";
+
+        measure("vector_t<particle_t>" + size, n, [&] {
+            float sum = 0;
+            for (particle_t const &particle : aos) {
+                sum += particle.mass;
+            }
+            return sum;
+        });
+        measure("soa_vector_t column" + size, n, [&] {
+            float sum = 0;
+            for (float mass : soa.column<3>()) {
+                sum += mass;
+            }
+            return sum;
+        });
+        measure("soa_struct_vector_t col<&particle_t::mass>" + size, n, [&] {
+            float sum = 0;
+            for (float mass : mapped.col<&particle_t::mass>()) {
+                sum += mass;
+            }
+            return sum;
+        });
+    }
+}
+
+/// Body of a physics step, which reads and writes most of its fields.
+struct body_t {
+    float x, y, z;
+    float vx, vy, vz;
+    std::int32_t id;
+};
+
+TEST_CASE("Integrating positions: AoS vs SoA vs AoSoA", "[soa][aosoa]") {
+    // x += vx * dt touches six fields of every body: the array of structures
+    // interleaves them with unused ones, the structure of arrays reads six
+    // distant streams, and AoSoA tiles read six neighbouring arrays of 16
+    // floats, each one a single 64 bytes vector.
+    float const dt = 0.01f;
+    for (std::size_t n : {10'000, 10'000'000}) {
+        vector_t<body_t> aos;
+        soa_struct_vector_t<body_t> soa;
+        aosoa_vector_t<body_t, 16> aosoa;
+        aos.reserve(n);
+        soa.reserve(n);
+        aosoa.reserve(n);
+        for (std::size_t i = 0; i < n; i++) {
+            float const f = float(i % 100);
+            body_t const body{f, f, f, 1.f, 2.f, 3.f, std::int32_t(i)};
+            aos.emplace_back(body);
+            soa.push_back(body);
+            aosoa.push_back(body);
+        }
+        std::string const size = ", " + std::to_string(n) + " bodies";
+
+        measure("vector_t<body_t>" + size, n, [&] {
+            for (body_t &body : aos) {
+                body.x += body.vx * dt;
+                body.y += body.vy * dt;
+                body.z += body.vz * dt;
+            }
+            return aos[n - 1].x;
+        });
+        measure("soa_struct_vector_t<body_t>" + size, n, [&] {
+            std::span<float> const x = soa.col<&body_t::x>(), y = soa.col<&body_t::y>(),
+                                   z = soa.col<&body_t::z>();
+            std::span<float const> const vx = soa.col<&body_t::vx>(),
+                                         vy = soa.col<&body_t::vy>(),
+                                         vz = soa.col<&body_t::vz>();
+            for (std::size_t i = 0; i < n; i++) {
+                x[i] += vx[i] * dt;
+                y[i] += vy[i] * dt;
+                z[i] += vz[i] * dt;
+            }
+            return x[n - 1];
+        });
+        measure("aosoa_vector_t<body_t, 16>" + size, n, [&] {
+            for (auto tile : aosoa.tiles()) {
+                std::span<float> const x = tile.col<&body_t::x>(), y = tile.col<&body_t::y>(),
+                                       z = tile.col<&body_t::z>();
+                std::span<float> const vx = tile.col<&body_t::vx>(),
+                                       vy = tile.col<&body_t::vy>(),
+                                       vz = tile.col<&body_t::vz>();
+                for (std::size_t l = 0; l < x.size(); l++) {
+                    x[l] += vx[l] * dt;
+                    y[l] += vy[l] * dt;
+                    z[l] += vz[l] * dt;
+                }
+            }
+            return std::get<0>(aosoa[n - 1]);
+        });
+    }
+}
+
+/// Sums the values of a vector with a plain loop over its begin() and end().
+template<typename Vector>
+std::int64_t sum_of(Vector const &vec) {
+    std::int64_t sum = 0;
+    for (auto it = vec.begin(); it != vec.end(); ++it) {
+        sum += *it;
+    }
+    return sum;
+}
+
+TEST_CASE("Reducing int32_t columns: aligned vs unaligned", "[alignment]") {
+    // Both spans come from the same cache-line-aligned buffer, the unaligned
+    // one starts 4 bytes further: each 64 bytes AVX-512 load then straddles
+    // two cache lines, and 32 bytes AVX2 loads do every other time. Levels go
+    // up to simd_level(), which VECTOR_T_SIMD caps (eg. VECTOR_T_SIMD=avx2).
+    // Spans decay to plain pointers, so the alignment hint of aligned_vector_t
+    // is only used by the loops over the vectors themselves.
+    for (std::size_t n : {10'000, 10'000'000}) {
+        aligned_vector_t<std::int32_t> buffer(n + 1, default_init);
+        for (std::size_t i = 0; i <= n; i++) {
+            buffer[i] = std::int32_t(i % 1000);
+        }
+        std::span<std::int32_t const> const aligned(buffer.data(), n);
+        std::span<std::int32_t const> const unaligned(buffer.data() + 1, n);
+        std::string const size = ", " + std::to_string(n) + " values";
+
+        for (auto [values, alignment] : {std::pair(aligned, ", aligned"),
+                                         std::pair(unaligned, ", unaligned")}) {
+            measure("std::accumulate" + std::string(alignment) + size, n, [&] {
+                return std::accumulate(values.begin(), values.end(), std::int64_t(0));
+            });
+            for (int l = 0; l <= int(simd_level()); l++) {
+                simd_level_t const level = simd_level_t(l);
+                measure("simd_minmax, " + std::string(simd_level_name(level)) + alignment + size,
+                        n, [&] { return simd_minmax(values, level).first; });
+            }
+        }
+
+        // The same loop over the vectors themselves: begin() of an
+        // aligned_vector_t tells the compiler that the values start on a
+        // cache line (std::assume_aligned), while the buffer of a vector_t is
+        // only known to be aligned on 4 bytes
+        aligned_vector_t<std::int32_t> hinted(n, default_init);
+        vector_t<std::int32_t> plain(n, default_init);
+        std::copy(aligned.begin(), aligned.end(), hinted.begin());
+        std::copy(aligned.begin(), aligned.end(), plain.begin());
+        measure("aligned_vector_t, begin() to end()" + size, n, [&] { return sum_of(hinted); });
+        measure("vector_t, begin() to end()" + size, n, [&] { return sum_of(plain); });
+    }
+}
@@ -0,0 +1,73 @@
+/// Tests for the vector_t statistics, which are only compiled in with
+/// VECTOR_T_STATS defined (see vector_stats.hpp). They live in their own
+/// executable, since the macro must be the same in a whole program.
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "malloc_allocator.hpp"
+#include "vector.hpp"
+
+static_assert(vector_stats_enabled, "vector_stats_test_exec must define VECTOR_T_STATS");
+
+TEST_CASE("Allocation statistics") {
+    using vec_t = vector_t<long>;
+    vector_stats_snapshot_t const before = vector_stats<vec_t>();
+
+    {
+        vec_t vec;
+        //16, 32, 64, 128 values: 4 relocations moving 0 + 16 + 32 + 64 values
+        for (long i = 0; i < 100; i++) {
+            vec.emplace_back(i);
+        }
+        vec_t copy(vec);
+        CHECK(copy.size() == 100);
+    }
+
+    vector_stats_snapshot_t const after = vector_stats<vec_t>();
+    CHECK(after.allocations - before.allocations == 5);
+    CHECK(after.deallocations - before.deallocations == 5);
+    CHECK(after.bytes_allocated - before.bytes_allocated ==
+          (16 + 32 + 64 + 128 + 128) * sizeof(long));
+    CHECK(after.relocations - before.relocations == 4);
+    CHECK(after.elements_moved - before.elements_moved == 16 + 32 + 64);
+    CHECK(after.growth_histogram[4] - before.growth_histogram[4] == 1);
+    CHECK(after.growth_histogram[5] - before.growth_histogram[5] == 1);
+    CHECK(after.growth_histogram[6] - before.growth_histogram[6] == 1);
+    CHECK(after.growth_histogram[7] - before.growth_histogram[7] == 1);
+
+    SECTION("Statistics are kept per vector type") {
+        vector_stats_snapshot_t const ints = vector_stats<vector_t<int>>();
+        {
+            vector_t<int> vec(10);
+        }
+        CHECK(vector_stats<vector_t<int>>().allocations - ints.allocations == 1);
+        CHECK(vector_stats<vec_t>().allocations == after.allocations);
+    }
+
+    SECTION("In-place reallocations are counted") {
+        using realloc_vec_t = vector_t<int, malloc_allocator_t<int>>;
+        vector_stats_snapshot_t const start = vector_stats<realloc_vec_t>();
+        {
+            realloc_vec_t vec;
+            vec.reserve(10);
+            vec.reserve(100000);
+        }
+        vector_stats_snapshot_t const end = vector_stats<realloc_vec_t>();
+        CHECK(end.relocations - start.relocations == 2);
+        CHECK(end.allocations - start.allocations == 2);
+        CHECK(end.deallocations - start.deallocations == 2);
+        CHECK(end.bytes_allocated - start.bytes_allocated >= (10 + 100000) * sizeof(int));
+    }
+
+    SECTION("The dump lists every vector type") {
+        std::ostringstream out;
+        dump_vector_stats(out);
+        std::string const dump = out.str();
+        CHECK(dump.find("vector_t<long") != std::string::npos);
+        CHECK(dump.find("capacity in [2^7, 2^8)") != std::string::npos);
+    }
+}